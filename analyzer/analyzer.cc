@@ -0,0 +1,510 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ======================================================
+//
+//  TCP/UDP KPIs straight from the scenario's pcap files.
+//
+//  Every file is mmapped and decoded in one pass (PPP, Ethernet and
+//  802.11 link types, the three the scenario writes), without the
+//  tcpdump text step. One csv row per flow and file goes to stdout:
+//  packets, bytes, unique and retransmitted TCP data, goodput, the last
+//  sequence number sent and acknowledged, RTT samples, and drops when
+//  the file is a _drop.pcap. Sequence numbers are absolute, as in the
+//  header and in logparser's tables. With --outputDir the per-packet seq/ack
+//  progress and the RTT samples are written next to it as well.
+//
+//  ./analyzer --outputDir=analysis scratch/sender_p2p_receiver_tcp-0-0.pcap scratch/sender_p2p_receiver_tcp_drop.pcap
+//
+// ======================================================
+
+
+enum LinkType {
+    DLT_EN10MB = 1,
+    DLT_PPP = 9,
+    DLT_IEEE802_11 = 105
+};
+
+
+struct FlowKey {
+    uint32_t src;
+    uint32_t dst;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint8_t protocol;
+
+    bool operator==(const FlowKey & other) const {
+        return src == other.src && dst == other.dst && srcPort == other.srcPort
+            && dstPort == other.dstPort && protocol == other.protocol;
+    }
+
+    FlowKey Reverse(void) const {
+        return { dst, src, dstPort, srcPort, protocol };
+    }
+};
+
+
+struct FlowKeyHash {
+    size_t operator()(const FlowKey & key) const {
+        uint64_t h = (uint64_t(key.src) << 32) ^ key.dst;
+        h ^= (uint64_t(key.srcPort) << 40) ^ (uint64_t(key.dstPort) << 24) ^ key.protocol;
+        return std::hash<uint64_t>()(h * 0x9e3779b97f4a7c15ULL);
+    }
+};
+
+
+/* first transmission of a TCP segment, waiting for the ACK that covers it */
+struct Outstanding {
+    int64_t end;
+    double time;
+};
+
+
+/* one direction of a TCP or UDP conversation */
+struct Flow {
+    FlowKey key;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;             // IP total length
+    uint64_t payloadBytes = 0;
+    uint64_t uniqueBytes = 0;       // tcp: payload above the highest sequence sent so far
+    uint64_t retransmissions = 0;
+    double start = 0.0;
+    double end = 0.0;
+
+    // tcp sequence space of this flow, relative to its first sequence number
+    bool seqInit = false;
+    uint32_t seqRaw = 0;
+    int64_t seq = 0;
+    int64_t highestSeq = 0;         // end of the highest segment sent
+    int64_t highestAck = 0;         // highest ACK the reverse flow sent for it
+    std::deque<Outstanding> outstanding;
+
+    // acks this flow sends, unwrapped in the reverse flow's sequence space
+    bool ackInit = false;
+    uint32_t ackRaw = 0;
+    int64_t ack = 0;
+
+    // udp echo: time of the latest request, matched by the next reply
+    double pendingRequest = -1.0;
+
+    uint64_t rttSamples = 0;
+    double rttSum = 0.0;
+    double rttMin = 0.0;
+    double rttMax = 0.0;
+};
+
+
+struct Capture {
+    std::string path;
+    bool dropFile;
+    std::vector<Flow> flows;        // first seen order
+    std::unordered_map<FlowKey, size_t, FlowKeyHash> index;
+    std::FILE * seqSeries = nullptr;
+    std::FILE * rttSeries = nullptr;
+    uint64_t records = 0;
+    uint64_t undecoded = 0;         // non-IPv4, 802.11 management/control, MAC retries, truncated
+};
+
+
+static void Usage(const char * argv0) {
+    std::cerr << "usage: " << argv0 << " [options] FILE.pcap...\n"
+              << "  --outputDir=DIR         also write <file>_seq.csv and <file>_rtt.csv into DIR\n";
+}
+
+
+static bool StartsWith(const std::string & s, const std::string & prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+
+static bool EndsWith(const std::string & s, const std::string & suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+
+static std::string BaseName(const std::string & path) {
+    std::string name = path.substr(path.find_last_of('/') + 1);
+    return EndsWith(name, ".pcap") ? name.substr(0, name.size() - 5) : name;
+}
+
+
+static uint16_t Be16(const uint8_t * p) {
+    return uint16_t(p[0] << 8 | p[1]);
+}
+
+
+static uint32_t Be32(const uint8_t * p) {
+    return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3];
+}
+
+
+static std::string Address(uint32_t a) {
+    char s[16];
+    std::snprintf(s, sizeof(s), "%u.%u.%u.%u", a >> 24, (a >> 16) & 0xff, (a >> 8) & 0xff, a & 0xff);
+    return s;
+}
+
+
+static std::string FlowName(const FlowKey & key) {
+    return Address(key.src) + ":" + std::to_string(key.srcPort) + ">" + Address(key.dst) + ":" + std::to_string(key.dstPort);
+}
+
+
+/* offset of the IPv4 header in a link layer frame, or -1 */
+static int IpOffset(uint32_t linkType, const uint8_t * frame, uint32_t length) {
+    switch (linkType) {
+    case DLT_PPP:
+        if (length >= 2 && Be16(frame) == 0x0021) {
+            return 2;
+        }
+        // the drop pcap is DLT_PPP for every device, csma drops carry an Ethernet header
+        if (length >= 14 && Be16(frame + 12) == 0x0800) {
+            return 14;
+        }
+        return -1;
+    case DLT_EN10MB:
+        return length >= 14 && Be16(frame + 12) == 0x0800 ? 14 : -1;
+    case DLT_IEEE802_11: {
+        if (length < 24) {
+            return -1;
+        }
+        uint8_t type = (frame[0] >> 2) & 0x3;
+        uint8_t subtype = frame[0] >> 4;
+        uint8_t flags = frame[1];
+        // data frames with a body only; MAC retries repeat an MPDU already seen
+        if (type != 2 || (subtype & 0x4) || (flags & 0x08) || (flags & 0x40)) {
+            return -1;
+        }
+        int offset = 24;
+        if ((flags & 0x03) == 0x03) {
+            offset += 6;        // four address format
+        }
+        if (subtype & 0x8) {
+            offset += 2;        // QoS control
+        }
+        // LLC/SNAP, IPv4
+        if (length < uint32_t(offset) + 8 || frame[offset] != 0xaa || frame[offset + 1] != 0xaa || Be16(frame + offset + 6) != 0x0800) {
+            return -1;
+        }
+        return offset + 8;
+    }
+    default:
+        return -1;
+    }
+}
+
+
+/* 32 bit sequence number to a 64 bit offset from the first one seen */
+static int64_t Unwrap(uint32_t raw, bool & init, uint32_t & lastRaw, int64_t & last, uint32_t base) {
+    if (!init) {
+        init = true;
+        lastRaw = base;
+        last = 0;
+    }
+    last += int32_t(raw - lastRaw);
+    lastRaw = raw;
+    return last;
+}
+
+
+/* offset in the flow's sequence space to the absolute number, unwrapped past 2^32 */
+static int64_t Absolute(const Flow & flow, int64_t offset) {
+    return flow.seqInit ? int64_t(flow.seqRaw - uint32_t(flow.seq)) + offset : offset;
+}
+
+
+static void AddRtt(Capture & capture, Flow & flow, double now, double rtt) {
+    if (flow.rttSamples == 0 || rtt < flow.rttMin) {
+        flow.rttMin = rtt;
+    }
+    if (flow.rttSamples == 0 || rtt > flow.rttMax) {
+        flow.rttMax = rtt;
+    }
+    flow.rttSamples++;
+    flow.rttSum += rtt;
+    if (capture.rttSeries) {
+        std::fprintf(capture.rttSeries, "%.6f,%s,%.6f\n", now, FlowName(flow.key).c_str(), rtt);
+    }
+}
+
+
+static Flow & GetFlow(Capture & capture, const FlowKey & key, double now) {
+    auto it = capture.index.find(key);
+    if (it != capture.index.end()) {
+        return capture.flows[it->second];
+    }
+    capture.index[key] = capture.flows.size();
+    capture.flows.push_back(Flow());
+    Flow & flow = capture.flows.back();
+    flow.key = key;
+    flow.start = now;
+    return flow;
+}
+
+
+static Flow * FindFlow(Capture & capture, const FlowKey & key) {
+    auto it = capture.index.find(key);
+    return it == capture.index.end() ? nullptr : &capture.flows[it->second];
+}
+
+
+static void Tcp(Capture & capture, Flow & flow, double now, const uint8_t * tcp, uint32_t payload) {
+    uint32_t seqRaw = Be32(tcp + 4);
+    uint32_t ackRaw = Be32(tcp + 8);
+    uint8_t flags = tcp[13];
+    bool syn = flags & 0x02;
+    bool fin = flags & 0x01;
+
+    // sequence space, SYN and FIN take one number each
+    int64_t seq = Unwrap(seqRaw, flow.seqInit, flow.seqRaw, flow.seq, seqRaw);
+    int64_t end = seq + payload + (syn ? 1 : 0) + (fin ? 1 : 0);
+    bool retransmission = false;
+    if (end > seq) {
+        if (seq < flow.highestSeq) {
+            retransmission = true;
+            flow.retransmissions++;
+            // Karn: segments sent after this one can no longer be timed unambiguously
+            while (!flow.outstanding.empty() && flow.outstanding.back().end > seq) {
+                flow.outstanding.pop_back();
+            }
+        }
+        if (end > flow.highestSeq) {
+            flow.uniqueBytes += std::min<int64_t>(payload, end - std::max(seq, flow.highestSeq));
+            if (!retransmission) {
+                flow.outstanding.push_back({ end, now });
+            }
+            flow.highestSeq = end;
+        }
+    }
+
+    // acks cover the reverse flow's data
+    int64_t ack = 0;
+    char ackField[24] = "";
+    Flow * reverse = FindFlow(capture, flow.key.Reverse());
+    if ((flags & 0x10) && reverse && reverse->seqInit) {
+        // the reverse flow's first sequence number is its offset 0
+        uint32_t base = reverse->seqRaw - uint32_t(reverse->seq);
+        ack = Unwrap(ackRaw, flow.ackInit, flow.ackRaw, flow.ack, base);
+        std::snprintf(ackField, sizeof(ackField), "%lld", (long long) Absolute(*reverse, ack));
+        if (ack > reverse->highestAck) {
+            reverse->highestAck = ack;
+            double sent = -1.0;
+            while (!reverse->outstanding.empty() && reverse->outstanding.front().end <= ack) {
+                sent = reverse->outstanding.front().time;
+                reverse->outstanding.pop_front();
+            }
+            if (sent >= 0.0) {
+                AddRtt(capture, *reverse, now, now - sent);
+            }
+        }
+    }
+
+    if (capture.seqSeries) {
+        std::fprintf(capture.seqSeries, "%.6f,%s,%lld,%s,%u,%d\n", now, FlowName(flow.key).c_str(),
+                     (long long) Absolute(flow, seq), ackField, payload, retransmission ? 1 : 0);
+    }
+}
+
+
+static void Udp(Capture & capture, Flow & flow, double now) {
+    // echo: a reply answers the latest request of the reverse flow
+    Flow * reverse = FindFlow(capture, flow.key.Reverse());
+    if (reverse && reverse->pendingRequest >= 0.0) {
+        AddRtt(capture, *reverse, now, now - reverse->pendingRequest);
+        reverse->pendingRequest = -1.0;
+    }
+    else {
+        flow.pendingRequest = now;
+    }
+}
+
+
+static void Decode(Capture & capture, uint32_t linkType, double now, const uint8_t * frame, uint32_t captured) {
+    int offset = IpOffset(linkType, frame, captured);
+    if (offset < 0 || captured < uint32_t(offset) + 20 || (frame[offset] >> 4) != 4) {
+        capture.undecoded++;
+        return;
+    }
+    const uint8_t * ip = frame + offset;
+    captured -= offset;
+    uint32_t ipHeader = (ip[0] & 0x0f) * 4;
+    uint32_t ipLength = Be16(ip + 2);
+    uint8_t protocol = ip[9];
+    if ((protocol != 6 && protocol != 17) || captured < ipHeader + (protocol == 6 ? 20 : 8) || ipLength < ipHeader) {
+        capture.undecoded++;
+        return;
+    }
+    const uint8_t * l4 = ip + ipHeader;
+    FlowKey key = { Be32(ip + 12), Be32(ip + 16), Be16(l4), Be16(l4 + 2), protocol };
+    Flow & flow = GetFlow(capture, key, now);
+    flow.packets++;
+    flow.bytes += ipLength;
+    flow.end = now;
+
+    // lengths come from the headers, so snap-length captures count the same
+    if (protocol == 6) {
+        uint32_t tcpHeader = (l4[12] >> 4) * 4;
+        uint32_t payload = ipLength >= ipHeader + tcpHeader ? ipLength - ipHeader - tcpHeader : 0;
+        flow.payloadBytes += payload;
+        Tcp(capture, flow, now, l4, payload);
+    }
+    else {
+        uint32_t payload = ipLength >= ipHeader + 8 ? ipLength - ipHeader - 8 : 0;
+        flow.payloadBytes += payload;
+        flow.uniqueBytes += payload;
+        Udp(capture, flow, now);
+    }
+}
+
+
+static bool Analyze(Capture & capture) {
+    int fd = open(capture.path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << capture.path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 24) {
+        std::cerr << capture.path << ": not a pcap file\n";
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void * map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << capture.path << ": mmap: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+    const uint8_t * data = static_cast<const uint8_t *>(map);
+
+    // file header: magic tells the byte order and the timestamp unit
+    uint32_t magic;
+    std::memcpy(&magic, data, 4);
+    bool swap = magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1;
+    bool nano = magic == 0xa1b23c4d || magic == 0x4d3cb2a1;
+    if (!swap && !nano && magic != 0xa1b2c3d4) {
+        std::cerr << capture.path << ": not a pcap file\n";
+        munmap(map, size);
+        return false;
+    }
+    auto field = [swap](const uint8_t * p) {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return swap ? __builtin_bswap32(v) : v;
+    };
+    uint32_t linkType = field(data + 20);
+    double unit = nano ? 1e-9 : 1e-6;
+
+    size_t offset = 24;
+    while (offset + 16 <= size) {
+        const uint8_t * record = data + offset;
+        uint32_t captured = field(record + 8);
+        if (offset + 16 + captured > size) {
+            break;      // truncated last record
+        }
+        double now = field(record) + field(record + 4) * unit;
+        Decode(capture, linkType, now, record + 16, captured);
+        capture.records++;
+        offset += 16 + captured;
+    }
+
+    munmap(map, size);
+    return true;
+}
+
+
+static std::FILE * OpenSeries(const std::string & path, const char * header) {
+    std::FILE * file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "cannot create " << path << ": " << std::strerror(errno) << "\n";
+        return nullptr;
+    }
+    std::fputs(header, file);
+    return file;
+}
+
+
+int main(int argc, char *argv[]) {
+
+    std::string outputDir;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (StartsWith(arg, "--outputDir=")) {
+            outputDir = arg.substr(12);
+        }
+        else if (StartsWith(arg, "--")) {
+            Usage(argv[0]);
+            return 1;
+        }
+        else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        Usage(argv[0]);
+        return 1;
+    }
+    if (!outputDir.empty() && mkdir(outputDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "cannot create " << outputDir << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+
+    std::printf("file,flow,protocol,packets,bytes,payloadBytes,uniqueBytes,retransmissions,drops,"
+                "startSeconds,endSeconds,goodputBps,highestSeq,highestAck,rttSamples,meanRttSeconds,minRttSeconds,maxRttSeconds\n");
+    int failed = 0;
+    for (const std::string & path : files) {
+        Capture capture;
+        capture.path = path;
+        capture.dropFile = EndsWith(path, "_drop.pcap");
+        if (!outputDir.empty()) {
+            std::string base = outputDir + "/" + BaseName(path);
+            capture.seqSeries = OpenSeries(base + "_seq.csv", "time,flow,seq,ack,payload,retransmission\n");
+            capture.rttSeries = OpenSeries(base + "_rtt.csv", "time,flow,rttSeconds\n");
+        }
+
+        if (!Analyze(capture)) {
+            failed++;
+        }
+        for (const Flow & flow : capture.flows) {
+            double duration = flow.end - flow.start;
+            std::printf("%s,%s,%s,%llu,%llu,%llu,%llu,%llu,%llu,%.6f,%.6f,%.1f,%lld,%lld,%llu,%.6f,%.6f,%.6f\n",
+                        BaseName(path).c_str(), FlowName(flow.key).c_str(), flow.key.protocol == 6 ? "tcp" : "udp",
+                        (unsigned long long) flow.packets, (unsigned long long) flow.bytes,
+                        (unsigned long long) flow.payloadBytes, (unsigned long long) flow.uniqueBytes,
+                        (unsigned long long) flow.retransmissions, (unsigned long long) (capture.dropFile ? flow.packets : 0),
+                        flow.start, flow.end, duration > 0 ? flow.uniqueBytes * 8 / duration : 0.0,
+                        (long long) Absolute(flow, flow.highestSeq), (long long) Absolute(flow, flow.highestAck), (unsigned long long) flow.rttSamples,
+                        flow.rttSamples ? flow.rttSum / flow.rttSamples : 0.0, flow.rttMin, flow.rttMax);
+        }
+        if (capture.undecoded > 0) {
+            std::cerr << path << ": " << capture.records << " records, " << capture.undecoded << " not TCP/UDP over IPv4\n";
+        }
+
+        if (capture.seqSeries) {
+            std::fclose(capture.seqSeries);
+        }
+        if (capture.rttSeries) {
+            std::fclose(capture.rttSeries);
+        }
+    }
+
+
+    return failed > 0 ? 1 : 0;
+}
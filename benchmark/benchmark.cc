@@ -0,0 +1,617 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// ======================================================
+//
+//  Wall-time benchmark of the scenario program.
+//
+//  A suite is a list of cases; every case is one scenario command line,
+//  run --repeat times as a child process with --summary=true in its own
+//  case_<i> directory. The fastest repetition is kept, along with the
+//  child's peak RSS and the events per second of its summary, and each
+//  case is compared with the first case of its group.
+//
+//  ./benchmark --program=build/scratch/scenario/scenario --suite=pcap --seconds=100
+//
+//  --json writes the results as a baseline; --baseline compares the run
+//  with one and fails when a case's wall time, events per second or peak
+//  RSS got worse than --threshold allows.
+//
+// ======================================================
+
+
+struct Case {
+    std::string group;      // cases of a group are compared with its first case
+    std::string name;
+    std::vector<std::string> args;
+};
+
+
+struct Result {
+    double wallSeconds;
+    long peakRssKb;
+    int status;
+    double eventsPerSecond;     // Simulator::Run() only, from the summary csv
+};
+
+
+/* one case of a --json baseline */
+struct BaselineEntry {
+    double wallSeconds;
+    double eventsPerSecond;
+    double peakRssKb;
+};
+
+
+static void Usage(const char * argv0) {
+    std::cerr << "usage: " << argv0 << " --program=PATH [options]\n"
+              << "  --program=PATH          scenario binary (run it from ./waf shell)\n"
+              << "  --suite=NAME            pcap (default), speed, verbose, flowmon, scheduler, wifirange, mobility, loss, udpload\n"
+              << "  --seconds=N             simulated seconds per case (default: 100)\n"
+              << "  --sizes=N,N,...         scheduler, wifirange and mobility suites: node counts (default: 8,64,256)\n"
+              << "  --secondsList=N,N,...   speed suite: simulated seconds (default: 10,100,1000)\n"
+              << "  --repeat=N              repetitions per case, the fastest is kept (default: 3)\n"
+              << "  --outputDir=DIR         scenario output files (default: benchmark_out)\n"
+              << "  --json=FILE             write the results as a json baseline\n"
+              << "  --baseline=FILE         compare with a json baseline, exit 1 on a regression\n"
+              << "  --threshold=R           allowed change for the worse of wall time, events/s and peak RSS (default: 0.1, i.e. 10%)\n";
+}
+
+
+static bool StartsWith(const std::string & s, const std::string & prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+
+static std::vector<std::string> Split(const std::string & s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, sep)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+
+/* the three topologies of the README, as scenario options */
+static std::vector<std::string> Topologies(void) {
+    return { "--sender=none --receiver=none", "--sender=csma --receiver=csma", "--sender=wifi --receiver=csma" };
+}
+
+
+/* the six scenarios at every length, tracing off and on, every logging level */
+static std::vector<Case> SpeedSuite(const std::string & secondsList) {
+    std::vector<Case> cases;
+    for (const std::string & topology : Topologies()) {
+        for (const char * transport : { "udp", "tcp" }) {
+            for (const std::string & seconds : Split(secondsList, ',')) {
+                for (const char * tracing : { "false", "true" }) {
+                    for (const char * verbose : { "none", "stats", "info", "all" }) {
+                        Case c;
+                        c.group = topology + " --transport=" + transport + " --seconds=" + seconds;
+                        c.name = std::string("tracing=") + tracing + " verbose=" + verbose;
+                        c.args = Split(c.group + " --tracing=" + tracing + " --verbose=" + verbose, ' ');
+                        cases.push_back(c);
+                    }
+                }
+            }
+        }
+    }
+    return cases;
+}
+
+
+/* logging levels on every topology and transport */
+static std::vector<Case> VerboseSuite(const std::string & seconds) {
+    std::vector<Case> cases;
+    for (const std::string & topology : Topologies()) {
+        for (const char * transport : { "udp", "tcp" }) {
+            for (const char * verbose : { "all", "info", "stats" }) {
+                Case c;
+                c.group = topology + " --transport=" + transport;
+                c.name = std::string("verbose=") + verbose;
+                c.args = Split(c.group + " --verbose=" + verbose + " --seconds=" + seconds, ' ');
+                cases.push_back(c);
+            }
+        }
+    }
+    return cases;
+}
+
+
+/* flow monitor snapshots on and off, logging off */
+static std::vector<Case> FlowMonitorSuite(const std::string & seconds) {
+    std::vector<Case> cases;
+    for (const std::string & topology : Topologies()) {
+        for (const char * transport : { "udp", "tcp" }) {
+            for (const char * flowMonitor : { "false", "true" }) {
+                Case c;
+                c.group = topology + " --transport=" + transport;
+                c.name = std::string("flowMonitor=") + flowMonitor;
+                c.args = Split(c.group + " --verbose=none --flowMonitor=" + flowMonitor + " --seconds=" + seconds, ' ');
+                cases.push_back(c);
+            }
+        }
+    }
+    return cases;
+}
+
+
+/* the per packet RateErrorModel against the skip-ahead models, with losses on every site */
+static std::vector<Case> LossSuite(const std::string & seconds) {
+    std::vector<Case> cases;
+    for (const std::string & topology : Topologies()) {
+        for (const char * lossModel : { "rate", "bernoulli", "gilbert" }) {
+            Case c;
+            c.group = topology + " --transport=tcp";
+            c.name = std::string("lossModel=") + lossModel;
+            c.args = Split(c.group + " --verbose=none --receiverRanVarMin=0.44 --interRanVarMin=0.40 --lossModel=" + lossModel + " --seconds=" + seconds, ' ');
+            cases.push_back(c);
+        }
+    }
+    return cases;
+}
+
+
+/* UDP echo against the paced load generator at the 5Mbps p2p line rate */
+static std::vector<Case> UdpLoadSuite(const std::string & seconds) {
+    std::vector<Case> cases;
+    for (const std::string & topology : Topologies()) {
+        for (const char * app : { "udpApp=echo", "udpApp=load --loadMode=cbr", "udpApp=load --loadMode=poisson", "udpApp=load --loadMode=burst" }) {
+            Case c;
+            c.group = topology + " --transport=udp";
+            c.name = app;
+            c.args = Split(c.group + " --verbose=none --loadRate=5Mbps --" + app + " --seconds=" + seconds, ' ');
+            cases.push_back(c);
+        }
+    }
+    return cases;
+}
+
+
+/* every scheduler on growing wifi and csma networks */
+static std::vector<Case> SchedulerSuite(const std::string & seconds, const std::string & sizes) {
+    std::vector<Case> cases;
+    for (const std::string & size : Split(sizes, ',')) {
+        const std::pair<std::string, std::string> topologies[] = {
+            { "wifi wifiNumber=" + size, "--sender=wifi --receiver=none --wifiNumber=" + size },
+            { "csma csmaNumber=" + size, "--sender=csma --receiver=csma --csmaNumber=" + size },
+        };
+        for (const auto & topology : topologies) {
+            for (const char * scheduler : { "map", "heap", "calendar", "list", "dary" }) {
+                Case c;
+                c.group = topology.first;
+                c.name = std::string("scheduler=") + scheduler;
+                c.args = Split(topology.second + " --transport=tcp --verbose=none --scheduler=" + scheduler + " --seconds=" + seconds, ' ');
+                cases.push_back(c);
+            }
+        }
+    }
+    return cases;
+}
+
+
+/* the full Yans channel against the range pruned one on growing wifi networks */
+static std::vector<Case> WifiRangeSuite(const std::string & seconds, const std::string & sizes) {
+    std::vector<Case> cases;
+    for (const std::string & size : Split(sizes, ',')) {
+        for (const char * range : { "0", "250", "100" }) {
+            Case c;
+            c.group = "wifi wifiNumber=" + size + " senderShare=0.1";
+            c.name = std::string("wifiRange=") + range;
+            c.args = Split("--sender=wifi --receiver=none --transport=udp --wifiNumber=" + size + " --senderShare=0.1 --verbose=none --wifiRange=" + range + " --seconds=" + seconds, ' ');
+            cases.push_back(c);
+        }
+    }
+    return cases;
+}
+
+
+/* one random walk model per station against the batched block */
+static std::vector<Case> MobilitySuite(const std::string & seconds, const std::string & sizes) {
+    std::vector<Case> cases;
+    for (const std::string & size : Split(sizes, ',')) {
+        for (const char * mobility : { "walk", "batched" }) {
+            Case c;
+            c.group = "wifi wifiNumber=" + size;
+            c.name = std::string("mobility=") + mobility;
+            c.args = Split("--sender=wifi --receiver=none --transport=udp --wifiNumber=" + size + " --verbose=none --mobility=" + mobility + " --seconds=" + seconds, ' ');
+            cases.push_back(c);
+        }
+    }
+    return cases;
+}
+
+
+/* tracing on, capture files through PcapFileWrapper vs the async writer, full and headers only + sampled */
+static std::vector<Case> PcapSuite(const std::string & seconds) {
+    const std::vector<std::pair<std::string, std::string> > captures = {
+        { "ns3", "--pcapWriter=ns3" },
+        { "async", "--pcapWriter=async" },
+        { "async snap=128 sample=10", "--pcapWriter=async --pcapSnapLen=128 --pcapSample=10" },
+    };
+    std::vector<Case> cases;
+    for (const std::string & topology : Topologies()) {
+        for (const auto & capture : captures) {
+            Case c;
+            c.group = topology + " --transport=tcp";
+            c.name = capture.first;
+            c.args = Split(c.group + " --tracing=true --verbose=none " + capture.second + " --seconds=" + seconds, ' ');
+            cases.push_back(c);
+        }
+    }
+    return cases;
+}
+
+
+/* eventsPerSecond column of the <name>_summary.csv in dir, 0 if there is none */
+static double ReadEventsPerSecond(const std::string & dir) {
+    DIR * d = opendir(dir.c_str());
+    if (!d) {
+        return 0.0;
+    }
+    std::string summaryFile;
+    const std::string suffix = "_summary.csv";
+    while (struct dirent * entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            summaryFile = dir + "/" + name;
+            break;
+        }
+    }
+    closedir(d);
+    std::ifstream in(summaryFile.c_str());
+    std::string header, row;
+    if (summaryFile.empty() || !std::getline(in, header) || !std::getline(in, row)) {
+        return 0.0;
+    }
+    std::vector<std::string> names = Split(header, ',');
+    std::vector<std::string> values = Split(row, ',');
+    for (size_t i = 0; i < names.size() && i < values.size(); ++i) {
+        if (names[i] == "eventsPerSecond") {
+            return std::atof(values[i].c_str());
+        }
+    }
+    return 0.0;
+}
+
+
+/* simulated seconds of a case: the scenario stops one second after --seconds */
+static double SimulatedSeconds(const Case & c) {
+    double seconds = 10.0;
+    for (const std::string & arg : c.args) {
+        if (StartsWith(arg, "--seconds=")) {
+            seconds = std::atof(arg.c_str() + 10);
+        }
+    }
+    return seconds + 1.0;
+}
+
+
+static std::string JsonString(const std::string & s) {
+    std::string quoted = "\"";
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') {
+            quoted += '\\';
+        }
+        quoted += ch;
+    }
+    return quoted + "\"";
+}
+
+
+static bool WriteJson(const std::string & path, const std::string & suite, const std::vector<Case> & cases, const std::vector<Result> & results) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        std::cerr << "cannot create " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    out << "{\n  \"suite\": " << JsonString(suite) << ",\n  \"cases\": [\n";
+    for (size_t c = 0; c < cases.size(); ++c) {
+        const Result & r = results[c];
+        double simulated = SimulatedSeconds(cases[c]);
+        out << "    { \"group\": " << JsonString(cases[c].group) << ", \"name\": " << JsonString(cases[c].name)
+            << ", \"status\": " << r.status
+            << std::setprecision(6) << ", \"simulatedSeconds\": " << simulated
+            << ", \"wallSeconds\": " << r.wallSeconds
+            << ", \"simulatedPerWallSecond\": " << (r.wallSeconds > 0 ? simulated / r.wallSeconds : 0.0)
+            << ", \"eventsPerSecond\": " << r.eventsPerSecond
+            << ", \"peakRssKb\": " << r.peakRssKb << " }" << (c + 1 < cases.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return true;
+}
+
+
+/* a line for regressions when value is worse than base by more than threshold; a 0 means not measured */
+static void CompareMetric(const Case & c, const char * metric, double value, double base, bool higherIsWorse, double threshold,
+                          std::vector<std::string> & regressions) {
+    if (value <= 0 || base <= 0) {
+        return;
+    }
+    bool worse = higherIsWorse ? value > base * (1.0 + threshold) : value < base * (1.0 - threshold);
+    if (worse) {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3) << c.group << " " << c.name << ": " << metric << " "
+             << value << ", baseline " << base << " (" << std::showpos << std::setprecision(1)
+             << 100.0 * (value / base - 1.0) << "%)";
+        regressions.push_back(line.str());
+    }
+}
+
+
+/* the cases of a baseline written by WriteJson(), keyed by group and name */
+static bool ReadBaseline(const std::string & path, std::map<std::string, BaselineEntry> & baseline) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "cannot open " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        // one case per line: { "key": value, ... }
+        size_t open = line.find('{');
+        if (open == std::string::npos || line.find("\"group\"") == std::string::npos) {
+            continue;
+        }
+        std::map<std::string, std::string> fields;
+        size_t p = open + 1;
+        while ((p = line.find('"', p)) != std::string::npos) {
+            size_t keyEnd = line.find('"', p + 1);
+            std::string key = line.substr(p + 1, keyEnd - p - 1);
+            p = line.find_first_not_of(" :", keyEnd + 1);
+            std::string value;
+            if (line[p] == '"') {
+                for (++p; p < line.size() && line[p] != '"'; ++p) {
+                    if (line[p] == '\\') {
+                        ++p;
+                    }
+                    value += line[p];
+                }
+                ++p;
+            }
+            else {
+                size_t end = line.find_first_of(",}", p);
+                value = line.substr(p, end - p);
+                p = end;
+            }
+            fields[key] = value;
+        }
+        BaselineEntry entry;
+        entry.wallSeconds = std::atof(fields["wallSeconds"].c_str());
+        entry.eventsPerSecond = std::atof(fields["eventsPerSecond"].c_str());
+        entry.peakRssKb = std::atof(fields["peakRssKb"].c_str());
+        if (fields["status"] == "0") {
+            baseline[fields["group"] + "|" + fields["name"]] = entry;
+        }
+    }
+    return true;
+}
+
+
+static Result RunOnce(const std::string & program, const std::vector<std::string> & args, const std::string & logFile) {
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = open(logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        std::vector<char *> argv;
+        argv.push_back(const_cast<char *>(program.c_str()));
+        for (const std::string & arg : args) {
+            argv.push_back(const_cast<char *>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        execv(program.c_str(), argv.data());
+        std::perror("execv");
+        _exit(127);
+    }
+
+    Result result = { 0.0, 0, -1, 0.0 };
+    if (pid < 0) {
+        std::perror("fork");
+        return result;
+    }
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        std::perror("wait4");
+        return result;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    result.wallSeconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) * 1e-9;
+    result.peakRssKb = usage.ru_maxrss;
+    result.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    return result;
+}
+
+
+int main(int argc, char *argv[]) {
+
+    std::string program;
+    std::string suite = "pcap";
+    std::string seconds = "100";
+    int repeat = 3;
+    std::string outputDir = "benchmark_out";
+    std::string sizes = "8,64,256";
+    std::string secondsList = "10,100,1000";
+    std::string jsonFile;
+    std::string baselineFile;
+    double threshold = 0.1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (StartsWith(arg, "--program=")) {
+            program = arg.substr(10);
+        }
+        else if (StartsWith(arg, "--suite=")) {
+            suite = arg.substr(8);
+        }
+        else if (StartsWith(arg, "--seconds=")) {
+            seconds = arg.substr(10);
+        }
+        else if (StartsWith(arg, "--repeat=")) {
+            repeat = std::max(1, std::atoi(arg.c_str() + 9));
+        }
+        else if (StartsWith(arg, "--sizes=")) {
+            sizes = arg.substr(8);
+        }
+        else if (StartsWith(arg, "--outputDir=")) {
+            outputDir = arg.substr(12);
+        }
+        else if (StartsWith(arg, "--secondsList=")) {
+            secondsList = arg.substr(14);
+        }
+        else if (StartsWith(arg, "--json=")) {
+            jsonFile = arg.substr(7);
+        }
+        else if (StartsWith(arg, "--baseline=")) {
+            baselineFile = arg.substr(11);
+        }
+        else if (StartsWith(arg, "--threshold=")) {
+            threshold = std::atof(arg.c_str() + 12);
+        }
+        else {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Case> cases;
+    if (suite == "pcap") {
+        cases = PcapSuite(seconds);
+    }
+    else if (suite == "speed") {
+        cases = SpeedSuite(secondsList);
+    }
+    else if (suite == "verbose") {
+        cases = VerboseSuite(seconds);
+    }
+    else if (suite == "flowmon") {
+        cases = FlowMonitorSuite(seconds);
+    }
+    else if (suite == "scheduler") {
+        cases = SchedulerSuite(seconds, sizes);
+    }
+    else if (suite == "wifirange") {
+        cases = WifiRangeSuite(seconds, sizes);
+    }
+    else if (suite == "mobility") {
+        cases = MobilitySuite(seconds, sizes);
+    }
+    else if (suite == "loss") {
+        cases = LossSuite(seconds);
+    }
+    else if (suite == "udpload") {
+        cases = UdpLoadSuite(seconds);
+    }
+    if (program.empty() || cases.empty()) {
+        Usage(argv[0]);
+        return 1;
+    }
+    if (mkdir(outputDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "cannot create " << outputDir << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    std::map<std::string, BaselineEntry> baseline;
+    if (!baselineFile.empty() && !ReadBaseline(baselineFile, baseline)) {
+        return 1;
+    }
+
+
+    /* run */
+    size_t groupWidth = 48;
+    size_t nameWidth = 24;
+    for (const Case & c : cases) {
+        groupWidth = std::max(groupWidth, c.group.size() + 2);
+        nameWidth = std::max(nameWidth, c.name.size() + 2);
+    }
+    std::cout << std::left << std::setw(groupWidth) << "group" << std::setw(nameWidth) << "case"
+              << std::right << std::setw(12) << "wall (s)" << std::setw(14) << "sim s/wall s" << std::setw(14) << "peak RSS (MB)" << std::setw(14) << "events/s" << std::setw(10) << "speedup" << "\n";
+    std::string group;
+    double groupBaseline = 0.0;
+    int failed = 0;
+    std::vector<Result> results;
+    std::vector<std::string> regressions;
+    for (size_t c = 0; c < cases.size(); ++c) {
+        std::string caseDir = outputDir + "/case_" + std::to_string(c);
+        mkdir(caseDir.c_str(), 0755);
+        std::vector<std::string> args = cases[c].args;
+        args.push_back("--outputDir=" + caseDir);
+        args.push_back("--summary=true");
+        Result best = { 0.0, 0, -1, 0.0 };
+        for (int r = 0; r < repeat; ++r) {
+            Result result = RunOnce(program, args, caseDir + "/stdout.log");
+            result.eventsPerSecond = ReadEventsPerSecond(caseDir);
+            if (result.status != 0) {
+                best = result;
+                break;
+            }
+            if (best.status != 0 || result.wallSeconds < best.wallSeconds) {
+                best = result;
+            }
+        }
+        results.push_back(best);
+        if (cases[c].group != group) {
+            group = cases[c].group;
+            groupBaseline = best.wallSeconds;
+        }
+
+        std::cout << std::left << std::setw(groupWidth) << cases[c].group << std::setw(nameWidth) << cases[c].name << std::right;
+        if (best.status != 0) {
+            std::cout << "  failed with status " << best.status << " (see " << caseDir << "/stdout.log)\n";
+            failed++;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(12) << best.wallSeconds
+                  << std::setprecision(1) << std::setw(14) << (best.wallSeconds > 0 ? SimulatedSeconds(cases[c]) / best.wallSeconds : 0.0)
+                  << std::setprecision(1) << std::setw(14) << best.peakRssKb / 1024.0
+                  << std::setprecision(0) << std::setw(14) << best.eventsPerSecond
+                  << std::setprecision(2) << std::setw(9) << (best.wallSeconds > 0 ? groupBaseline / best.wallSeconds : 0.0) << "x\n";
+
+        auto base = baseline.find(cases[c].group + "|" + cases[c].name);
+        if (base != baseline.end()) {
+            CompareMetric(cases[c], "wallSeconds", best.wallSeconds, base->second.wallSeconds, true, threshold, regressions);
+            CompareMetric(cases[c], "eventsPerSecond", best.eventsPerSecond, base->second.eventsPerSecond, false, threshold, regressions);
+            CompareMetric(cases[c], "peakRssKb", best.peakRssKb, base->second.peakRssKb, true, threshold, regressions);
+        }
+    }
+
+    if (!jsonFile.empty() && !WriteJson(jsonFile, suite, cases, results)) {
+        failed++;
+    }
+    if (!baselineFile.empty()) {
+        std::cout << "\n" << regressions.size() << " regressions above " << std::setprecision(0) << threshold * 100 << "% against " << baselineFile << "\n";
+        for (const std::string & regression : regressions) {
+            std::cout << "  " << regression << "\n";
+        }
+    }
+
+
+    return failed > 0 || !regressions.empty() ? 1 : 0;
+}
@@ -0,0 +1,615 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ======================================================
+//
+//  Columnar time series from the text logs of earlier runs.
+//
+//  Every .dat file is mmapped and read once, line by line; the three
+//  formats under logs/ are recognised per line, so a file may mix them:
+//
+//    At time +2s client sent 1024 bytes to 10.1.1.2 port 9     UdpEcho log
+//    ReceiverRxDrop at 97.0519                                 drop print
+//    3.0081 IP 10.1.1.1.49153 > 10.1.1.2.8080: Flags [.], ...  tcpdump text
+//    3.0600 unknown PPP protocol (0x0000)                      tcpdump hex
+//        0x0000:  0000 000a 0000 0000 0007 0800 4500 024c      dump of a
+//                                                              csma drop
+//
+//  Per file up to four tables are written, as csv or as one raw
+//  little-endian float64 file per column (--format=columns):
+//
+//    echo      sendSeconds,serverSeconds,receiveSeconds,rttSeconds (nan when lost)
+//    drops     seconds,site (0 receiver, 1 inter),flow,seq,length
+//    segments  seconds,flow,flags,seqStart,seqEnd,ack,length
+//    flows     flow index -> "src.port>dst.port", csv only
+//
+//  tcpdump prints the first packet of a connection with absolute
+//  sequence numbers and the later ones relative to it; the tables hold
+//  absolute ones, the TCP header values, so the relative ones are
+//  rebased. Logs of tcpdump -S need no rebasing and pass unchanged.
+//
+//  --schedule=true adds <name>_drops.sched, the drops sorted by time in
+//  the binary format the scenario's --lossModel=replay reads (see
+//  scenario/replay_error_model.h).
+//
+//  ./logparser --outputDir=parsed logs/*.dat
+//
+// ======================================================
+
+
+/* table of double columns, rows appended as the file is read */
+struct Table {
+    std::string name;
+    std::vector<std::string> columns;
+    std::vector<std::vector<double> > data;     // one vector per column
+
+    Table(const std::string & name, const std::vector<std::string> & columns)
+        : name(name), columns(columns), data(columns.size()) {
+    }
+
+    void Add(const std::vector<double> & row) {
+        for (size_t c = 0; c < data.size(); ++c) {
+            data[c].push_back(row[c]);
+        }
+    }
+
+    size_t Rows(void) const {
+        return data.empty() ? 0 : data[0].size();
+    }
+};
+
+
+enum DropSite {
+    RECEIVER_DROP,
+    INTER_DROP
+};
+
+
+/* tcp flag bits, as tcpdump prints them inside Flags [...] */
+static const char TCP_FLAGS[] = "FSRP.U";
+
+
+struct Parser {
+    // tcpdump drop files: IP lines are drops; without a receiver access
+    // network the p2p device is the receiver device
+    bool dropFile;
+    bool receiverAccess;
+
+    Table echo = Table("echo", { "sendSeconds", "serverSeconds", "receiveSeconds", "rttSeconds" });
+    Table drops = Table("drops", { "seconds", "site", "flow", "seq", "length" });
+    Table segments = Table("segments", { "seconds", "flow", "flags", "seqStart", "seqEnd", "ack", "length" });
+    std::vector<std::string> flows;
+    // flow name -> the absolute sequence number tcpdump prints it relative to
+    std::map<std::string, double> seqBase;
+
+    // hex dump of an unknown PPP protocol record, decoded when it ends
+    bool inDump = false;
+    double dumpTime = 0.0;
+    std::vector<uint8_t> dump;
+
+    uint64_t lines = 0;
+    uint64_t skipped = 0;
+};
+
+
+static void Usage(const char * argv0) {
+    std::cerr << "usage: " << argv0 << " [options] FILE.dat...\n"
+              << "  --outputDir=DIR         output directory (default: parsed)\n"
+              << "  --format=FORMAT         csv (default), columns (raw float64 per column)\n"
+              << "  --schedule=BOOL         also write the drops as a replay schedule, <name>_drops.sched\n";
+}
+
+
+static bool StartsWith(const std::string & s, const std::string & prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+
+static bool StartsWith(const char * p, const char * end, const char * prefix) {
+    size_t n = std::strlen(prefix);
+    return size_t(end - p) >= n && std::memcmp(p, prefix, n) == 0;
+}
+
+
+/* pointer to the first occurrence of needle in [p, end), or end */
+static const char * Find(const char * p, const char * end, const char * needle) {
+    size_t n = std::strlen(needle);
+    for (; size_t(end - p) >= n; ++p) {
+        if (*p == needle[0] && std::memcmp(p, needle, n) == 0) {
+            return p;
+        }
+    }
+    return end;
+}
+
+
+/* decimal number with optional fraction, no exponent; advances p */
+static bool ParseNumber(const char *& p, const char * end, double & value) {
+    const char * start = p;
+    double v = 0.0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p++ - '0');
+    }
+    if (p < end && *p == '.') {
+        // digits as an integer, one division, so 2.10337 parses as strtod does
+        double fraction = 0.0;
+        double scale = 1.0;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            fraction = fraction * 10 + (*p - '0');
+            scale *= 10;
+        }
+        v += fraction / scale;
+    }
+    value = v;
+    return p != start;
+}
+
+
+static int Hex(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+
+static double FlowIndex(Parser & parser, const std::string & flow) {
+    for (size_t i = 0; i < parser.flows.size(); ++i) {
+        if (parser.flows[i] == flow) {
+            return double(i);
+        }
+    }
+    parser.flows.push_back(flow);
+    return double(parser.flows.size() - 1);
+}
+
+
+/* "IP a.p > b.q" -> "IP b.q > a.p" */
+static std::string ReverseFlow(const std::string & flow) {
+    size_t arrow = flow.find(" > ");
+    return arrow == std::string::npos ? flow : "IP " + flow.substr(arrow + 3) + " > " + flow.substr(3, arrow - 3);
+}
+
+
+/* relative to absolute, modulo 2^32 as in the header */
+static double Rebase(double relative, double base) {
+    return std::isnan(relative) || std::isnan(base) ? relative : std::fmod(relative + base, 4294967296.0);
+}
+
+
+/*
+ * As tcpdump tracks a connection: a SYN, or its first packet in either
+ * direction, is printed absolute and sets the base of both directions
+ * (the reverse one from ack - 1); later packets are relative to them.
+ */
+static void Absolute(Parser & parser, const std::string & flow, bool syn, double & seqStart, double & seqEnd, double & ack) {
+    std::string reverse = ReverseFlow(flow);
+    auto own = parser.seqBase.find(flow);
+    auto other = parser.seqBase.find(reverse);
+    if (syn || (own == parser.seqBase.end() && other == parser.seqBase.end())) {
+        parser.seqBase[flow] = seqStart;
+        parser.seqBase[reverse] = ack - 1;
+        return;
+    }
+    if (own == parser.seqBase.end() || std::isnan(own->second)) {
+        // opened by a reverse packet without an ack, this one starts the direction
+        parser.seqBase[flow] = seqStart;
+    }
+    else {
+        seqStart = Rebase(seqStart, own->second);
+        seqEnd = Rebase(seqEnd, own->second);
+    }
+    if (other != parser.seqBase.end()) {
+        ack = Rebase(ack, other->second);
+    }
+}
+
+
+/* At time +2.05169s client sent|client received|server received ... */
+static void EchoLine(Parser & parser, const char * p, const char * end) {
+    double t;
+    p += 9;
+    if (!ParseNumber(p, end, t)) {
+        parser.skipped++;
+        return;
+    }
+    Table & echo = parser.echo;
+    size_t last = echo.Rows();
+    // a reply or a server receive belongs to the latest request, requests are 1 s apart
+    if (Find(p, end, "client sent") != end) {
+        echo.Add({ t, NAN, NAN, NAN });
+    }
+    else if (Find(p, end, "server received") != end && last > 0) {
+        echo.data[1][last - 1] = t;
+    }
+    else if (Find(p, end, "client received") != end && last > 0) {
+        echo.data[2][last - 1] = t;
+        echo.data[3][last - 1] = t - echo.data[0][last - 1];
+    }
+}
+
+
+/* 3.008192 IP 10.1.1.1.49153 > 10.1.1.2.8080: Flags [.], seq 1:537, ack 1, win 32768, options [...], length 536: HTTP */
+static void IpLine(Parser & parser, double t, const char * p, const char * end) {
+    const char * colon = Find(p, end, ": ");
+    if (colon == end) {
+        parser.skipped++;
+        return;
+    }
+    std::string name(p, colon);
+    double flow = FlowIndex(parser, name);
+    p = colon + 2;
+
+    double flags = 0;
+    double seqStart = NAN, seqEnd = NAN, ack = NAN, length = NAN;
+    const char * q = Find(p, end, "Flags [");
+    if (q != end) {
+        for (q += 7; q < end && *q != ']'; ++q) {
+            const char * bit = std::strchr(TCP_FLAGS, *q);
+            if (bit) {
+                flags += 1 << (bit - TCP_FLAGS);
+            }
+        }
+    }
+    q = Find(p, end, "seq ");
+    if (q != end) {
+        q += 4;
+        ParseNumber(q, end, seqStart);
+        seqEnd = seqStart;
+        if (q < end && *q == ':') {
+            ++q;
+            ParseNumber(q, end, seqEnd);
+        }
+    }
+    q = Find(p, end, "ack ");
+    if (q != end) {
+        q += 4;
+        ParseNumber(q, end, ack);
+    }
+    q = Find(p, end, "length ");
+    if (q != end) {
+        q += 7;
+        ParseNumber(q, end, length);
+    }
+    Absolute(parser, name, int(flags) & 2, seqStart, seqEnd, ack);
+
+    if (parser.dropFile) {
+        parser.drops.Add({ t, double(parser.receiverAccess ? INTER_DROP : RECEIVER_DROP), flow, seqStart, length });
+    }
+    else {
+        parser.segments.Add({ t, flow, flags, seqStart, seqEnd, ack, length });
+    }
+}
+
+
+/* end of an unknown PPP protocol record: an Ethernet frame minus the two
+   bytes tcpdump took as the PPP protocol, so IPv4 starts at byte 12 */
+static void EndDump(Parser & parser) {
+    if (!parser.inDump) {
+        return;
+    }
+    parser.inDump = false;
+    const std::vector<uint8_t> & b = parser.dump;
+    const size_t ip = 12;
+    if (b.size() < ip + 20 || b[ip - 2] != 0x08 || b[ip - 1] != 0x00 || (b[ip] >> 4) != 4) {
+        parser.skipped++;
+        return;
+    }
+    size_t ipHeader = (b[ip] & 0x0f) * 4;
+    double ipLength = b[ip + 2] << 8 | b[ip + 3];
+    size_t l4 = ip + ipHeader;
+    std::string flow;
+    char s[64];
+    std::snprintf(s, sizeof(s), "%u.%u.%u.%u", b[ip + 12], b[ip + 13], b[ip + 14], b[ip + 15]);
+    flow = s;
+    double seq = NAN, length = NAN;
+    if (b.size() >= l4 + 20) {
+        std::snprintf(s, sizeof(s), ".%u > %u.%u.%u.%u.%u", b[l4] << 8 | b[l4 + 1], b[ip + 16], b[ip + 17], b[ip + 18], b[ip + 19], b[l4 + 2] << 8 | b[l4 + 3]);
+        flow += s;
+        seq = double(uint32_t(b[l4 + 4]) << 24 | b[l4 + 5] << 16 | b[l4 + 6] << 8 | b[l4 + 7]);
+        length = ipLength - ipHeader - (b[l4 + 12] >> 4) * 4;
+    }
+    else {
+        std::snprintf(s, sizeof(s), " > %u.%u.%u.%u", b[ip + 16], b[ip + 17], b[ip + 18], b[ip + 19]);
+        flow += s;
+    }
+    parser.drops.Add({ parser.dumpTime, double(RECEIVER_DROP), FlowIndex(parser, "IP " + flow), seq, length });
+}
+
+
+/* \t0x0010:  0002 0000 3e06 0000 0a01 0203 0a01 0304 */
+static void DumpLine(Parser & parser, const char * p, const char * end) {
+    // only the headers are needed
+    if (parser.dump.size() >= 64) {
+        return;
+    }
+    const char * q = Find(p, end, ":  ");
+    for (q += 3; q + 1 < end; ) {
+        int hi = Hex(q[0]);
+        int lo = Hex(q[1]);
+        if (hi < 0 || lo < 0) {
+            if (*q != ' ') {
+                break;
+            }
+            ++q;
+            continue;
+        }
+        parser.dump.push_back(uint8_t(hi << 4 | lo));
+        q += 2;
+    }
+}
+
+
+static void Line(Parser & parser, const char * p, const char * end) {
+    parser.lines++;
+    if (*p == '\t' && parser.inDump) {
+        DumpLine(parser, p, end);
+        return;
+    }
+    EndDump(parser);
+
+    if (StartsWith(p, end, "At time +")) {
+        EchoLine(parser, p, end);
+    }
+    else if (StartsWith(p, end, "ReceiverRxDrop at ") || StartsWith(p, end, "InterRxDrop at ")) {
+        DropSite site = *p == 'R' ? RECEIVER_DROP : INTER_DROP;
+        const char * q = p + (site == RECEIVER_DROP ? 18 : 15);
+        double t;
+        if (ParseNumber(q, end, t)) {
+            parser.drops.Add({ t, double(site), NAN, NAN, NAN });
+        }
+    }
+    else if (*p >= '0' && *p <= '9') {
+        double t;
+        const char * q = p;
+        if (!ParseNumber(q, end, t) || q == end || *q != ' ') {
+            parser.skipped++;
+            return;
+        }
+        ++q;
+        if (StartsWith(q, end, "IP ")) {
+            IpLine(parser, t, q, end);
+        }
+        else if (StartsWith(q, end, "unknown PPP protocol")) {
+            parser.inDump = true;
+            parser.dumpTime = t;
+            parser.dump.clear();
+        }
+        // 802.11 management/control and ARP lines carry nothing for the tables
+    }
+}
+
+
+static bool Parse(const std::string & path, Parser & parser) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << path << ": " << std::strerror(errno) << "\n";
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        close(fd);
+        return true;
+    }
+    void * map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << path << ": mmap: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    const char * p = static_cast<const char *>(map);
+    const char * end = p + size;
+    while (p < end) {
+        const char * eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!eol) {
+            eol = end;
+        }
+        if (eol > p) {
+            Line(parser, p, eol);
+        }
+        p = eol + 1;
+    }
+    EndDump(parser);
+
+    munmap(map, size);
+    return true;
+}
+
+
+static bool WriteCsv(const Table & table, const std::string & path) {
+    std::FILE * file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "cannot create " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    for (size_t c = 0; c < table.columns.size(); ++c) {
+        std::fprintf(file, c ? ",%s" : "%s", table.columns[c].c_str());
+    }
+    std::fputc('\n', file);
+    for (size_t r = 0; r < table.Rows(); ++r) {
+        for (size_t c = 0; c < table.columns.size(); ++c) {
+            double v = table.data[c][r];
+            if (c) {
+                std::fputc(',', file);
+            }
+            if (!std::isnan(v)) {
+                std::fprintf(file, "%.9g", v);
+            }
+        }
+        std::fputc('\n', file);
+    }
+    std::fclose(file);
+    return true;
+}
+
+
+static bool WriteColumns(const Table & table, const std::string & dir) {
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "cannot create " << dir << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    for (size_t c = 0; c < table.columns.size(); ++c) {
+        std::string path = dir + "/" + table.columns[c] + ".f64";
+        std::FILE * file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "cannot create " << path << ": " << std::strerror(errno) << "\n";
+            return false;
+        }
+        std::fwrite(table.data[c].data(), sizeof(double), table.data[c].size(), file);
+        std::fclose(file);
+    }
+    return true;
+}
+
+
+/* same layout as DropScheduleRecord in scenario/replay_error_model.h */
+struct ScheduleRecord {
+    int64_t nanoseconds;
+    uint32_t seq;
+    uint8_t site;
+    uint8_t hasSeq;
+    uint16_t reserved;
+};
+
+
+static bool WriteSchedule(const Table & drops, const std::string & path) {
+    std::vector<ScheduleRecord> records(drops.Rows());
+    for (size_t r = 0; r < drops.Rows(); ++r) {
+        double seq = drops.data[3][r];
+        records[r].nanoseconds = std::llround(drops.data[0][r] * 1e9);
+        records[r].seq = std::isnan(seq) ? 0 : uint32_t(seq);
+        records[r].site = uint8_t(drops.data[1][r]);
+        records[r].hasSeq = !std::isnan(seq);
+        records[r].reserved = 0;
+    }
+    std::stable_sort(records.begin(), records.end(), [](const ScheduleRecord & a, const ScheduleRecord & b) {
+        return a.nanoseconds < b.nanoseconds;
+    });
+
+    std::FILE * file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "cannot create " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    uint64_t count = records.size();
+    std::fwrite("DROPSCH1", 1, 8, file);
+    std::fwrite(&count, sizeof(count), 1, file);
+    std::fwrite(records.data(), sizeof(ScheduleRecord), records.size(), file);
+    std::fclose(file);
+    return true;
+}
+
+
+int main(int argc, char *argv[]) {
+
+    std::string outputDir = "parsed";
+    std::string format = "csv";
+    bool schedule = false;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (StartsWith(arg, "--outputDir=")) {
+            outputDir = arg.substr(12);
+        }
+        else if (StartsWith(arg, "--format=")) {
+            format = arg.substr(9);
+        }
+        else if (StartsWith(arg, "--schedule=")) {
+            schedule = arg.substr(11) == "true";
+        }
+        else if (StartsWith(arg, "--")) {
+            Usage(argv[0]);
+            return 1;
+        }
+        else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty() || (format != "csv" && format != "columns")) {
+        Usage(argv[0]);
+        return 1;
+    }
+    if (mkdir(outputDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "cannot create " << outputDir << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+
+    std::printf("file,lines,unparsed,echoSent,echoReceived,meanRttSeconds,drops,segments\n");
+    int failed = 0;
+    for (const std::string & path : files) {
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".dat") == 0) {
+            name.resize(name.size() - 4);
+        }
+        Parser parser;
+        parser.dropFile = name.find("_drop") != std::string::npos;
+        parser.receiverAccess = name.find("_csma_receiver") != std::string::npos;
+        if (!Parse(path, parser)) {
+            failed++;
+            continue;
+        }
+
+        std::string base = outputDir + "/" + name + "_";
+        for (const Table * table : { &parser.echo, &parser.drops, &parser.segments }) {
+            if (table->Rows() == 0) {
+                continue;
+            }
+            bool ok = format == "csv" ? WriteCsv(*table, base + table->name + ".csv") : WriteColumns(*table, base + table->name);
+            if (!ok) {
+                failed++;
+            }
+        }
+        if (schedule && parser.drops.Rows() > 0 && !WriteSchedule(parser.drops, base + "drops.sched")) {
+            failed++;
+        }
+        if (!parser.flows.empty()) {
+            std::FILE * file = std::fopen((base + "flows.csv").c_str(), "w");
+            if (file) {
+                std::fprintf(file, "flow,name\n");
+                for (size_t i = 0; i < parser.flows.size(); ++i) {
+                    std::fprintf(file, "%zu,%s\n", i, parser.flows[i].c_str());
+                }
+                std::fclose(file);
+            }
+        }
+
+        size_t received = 0;
+        double rttSum = 0.0;
+        for (double rtt : parser.echo.data[3]) {
+            if (!std::isnan(rtt)) {
+                received++;
+                rttSum += rtt;
+            }
+        }
+        std::printf("%s,%llu,%llu,%zu,%zu,%.6f,%zu,%zu\n", name.c_str(), (unsigned long long) parser.lines, (unsigned long long) parser.skipped,
+                    parser.echo.Rows(), received, received ? rttSum / received : 0.0, parser.drops.Rows(), parser.segments.Rows());
+    }
+
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+#!/bin/sh
+# tcpdump prints the second drop of a flow relative to the first one: the
+# schedule must hold its absolute sequence number, 2585 + 488 = 3073.
+#
+#   sh logparser/test/seq_rebase.sh
+
+set -e
+dir=$(dirname "$0")
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+${CXX:-g++} -O2 -std=c++14 -o "$work/logparser" "$dir/../logparser.cc"
+"$work/logparser" --outputDir="$work" --schedule=true "$dir/two_drops_drop.dat" > /dev/null
+
+# DROPSCH1, count, then 16 byte records: nanoseconds, seq, site, hasSeq
+count=$(od -An -tu8 -j8 -N8 "$work/two_drops_drop_drops.sched" | tr -d ' ')
+first=$(od -An -tu4 -j24 -N4 "$work/two_drops_drop_drops.sched" | tr -d ' ')
+second=$(od -An -tu4 -j40 -N4 "$work/two_drops_drop_drops.sched" | tr -d ' ')
+csv=$(sed -n 3p "$work/two_drops_drop_drops.csv" | cut -d, -f4)
+if [ "$count" != 2 ] || [ "$first" != 2585 ] || [ "$second" != 3073 ] || [ "$csv" != 3073 ]; then
+    echo "FAIL: count $count, seq $first $second, csv $csv (expected 2, 2585 3073, 3073)"
+    exit 1
+fi
+echo "PASS"
@@ -0,0 +1,134 @@
+#include "scenario.h"
+#include "udp_load.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+// With --distributed every rank installs only the applications of its own
+// nodes. The helpers are still configured on every rank: attributes such as
+// the OnOff random variables take their RNG streams when they are set, so
+// every later stream number stays the one of the sequential run.
+
+
+/* the helper's attributes are converted once and shared by every sender */
+template <typename Helper>
+static void InstallSenders(const ScenarioConfig & config, Topology & topology, Helper & helper) {
+    for (uint32_t i = 0; i < topology.activeSenderNodes.GetN(); ++i) {
+        Ptr<Node> node = topology.activeSenderNodes.Get(i);
+        if (IsLocal(node)) {
+            topology.senderApps.Add(helper.Install(node));
+        }
+    }
+    topology.senderApps.Start(Seconds(2.0));
+    topology.senderApps.Stop(Seconds(config.seconds));
+}
+
+
+/* OnOff on and off times */
+static Ptr<ConstantRandomVariable> ConstantVariable(const std::string & value) {
+    return CreateObjectWithAttributes<ConstantRandomVariable>("Constant", DoubleValue(std::stod(value)));
+}
+
+
+/* udp: UdpEcho client on the sender, echo server on the receiver */
+static void InstallUdpEcho(const ScenarioConfig & config, Topology & topology) {
+    uint32_t senderMaxPackets = int(config.seconds) - 1;
+
+    // receiver
+    UdpEchoServerHelper echoReceiver(9);
+    if (IsLocal(topology.receiverNode)) {
+        topology.receiverApps = echoReceiver.Install(topology.receiverNode);
+        topology.receiverApps.Start(Seconds(1.0));
+        topology.receiverApps.Stop(Seconds(config.seconds + 1));
+    }
+
+    // sender
+    UdpEchoClientHelper echoSender(topology.receiverAddress, 9);
+    echoSender.SetAttribute("MaxPackets", UintegerValue(senderMaxPackets));
+    echoSender.SetAttribute("Interval", TimeValue(Seconds(config.senderInterval)));
+    echoSender.SetAttribute("PacketSize", UintegerValue(config.senderPacketSize));
+    InstallSenders(config, topology, echoSender);
+}
+
+
+/* the UdpEcho helpers' interface for the scenario's own applications */
+class ScenarioAppHelper {
+public:
+    explicit ScenarioAppHelper(const std::string & typeId) {
+        m_factory.SetTypeId(typeId);
+    }
+
+    void SetAttribute(const std::string & name, const AttributeValue & value) {
+        m_factory.Set(name, value);
+    }
+
+    ApplicationContainer Install(Ptr<Node> node) const {
+        Ptr<Application> app = m_factory.Create<Application>();
+        node->AddApplication(app);
+        return ApplicationContainer(app);
+    }
+
+private:
+    ObjectFactory m_factory;
+};
+
+
+/* udp load: paced generator on the sender, per packet records on the receiver */
+static void InstallUdpLoad(const ScenarioConfig & config, Topology & topology) {
+    // receiver
+    ScenarioAppHelper loadReceiver("UdpLoadSink");
+    loadReceiver.SetAttribute("Port", UintegerValue(9));
+    loadReceiver.SetAttribute("Output", StringValue(OutputPrefix(config) + "_load.bin"));
+    if (IsLocal(topology.receiverNode)) {
+        topology.receiverApps = loadReceiver.Install(topology.receiverNode);
+        topology.receiverApps.Start(Seconds(1.0));
+        topology.receiverApps.Stop(Seconds(config.seconds + 1));
+    }
+
+    // sender
+    ScenarioAppHelper loadSender("UdpLoadGenerator");
+    loadSender.SetAttribute("Remote", AddressValue(InetSocketAddress(topology.receiverAddress, 9)));
+    loadSender.SetAttribute("PacketSize", UintegerValue(config.senderPacketSize));
+    loadSender.SetAttribute("DataRate", DataRateValue(DataRate(config.loadRate)));
+    loadSender.SetAttribute("Mode", StringValue(config.loadMode));
+    loadSender.SetAttribute("BurstPackets", UintegerValue(config.loadBurst));
+    InstallSenders(config, topology, loadSender);
+}
+
+
+/* tcp: OnOff sender, PacketSink on the receiver */
+static void InstallTcpOnOff(const ScenarioConfig & config, Topology & topology) {
+    // receiver
+    uint16_t sinkPort = 8080;
+    Address sinkAddress(InetSocketAddress(Ipv4Address::GetAny(), sinkPort));
+    PacketSinkHelper packetSinkHelper("ns3::TcpSocketFactory", sinkAddress);
+    if (IsLocal(topology.receiverNode)) {
+        topology.receiverApps.Add(packetSinkHelper.Install(topology.receiverNode));
+        topology.receiverApps.Start(Seconds(1.0));
+        topology.receiverApps.Stop(Seconds(config.seconds + 1));
+    }
+
+    // sender
+    OnOffHelper onOffSender("ns3::TcpSocketFactory", Address());
+    onOffSender.SetAttribute("OnTime", PointerValue(ConstantVariable(config.senderOnTime)));
+    onOffSender.SetAttribute("OffTime", PointerValue(ConstantVariable(config.senderOffTime)));
+    onOffSender.SetAttribute("PacketSize", UintegerValue(config.senderPacketSize));
+    onOffSender.SetAttribute("DataRate", DataRateValue(DataRate(config.senderDataRate)));
+    onOffSender.SetAttribute("MaxBytes", UintegerValue(config.senderMaxBytes));
+    AddressValue remoteAddress(InetSocketAddress(topology.receiverAddress, sinkPort));
+    onOffSender.SetAttribute("Remote", remoteAddress);
+    InstallSenders(config, topology, onOffSender);
+}
+
+
+void InstallApplications(const ScenarioConfig & config, Topology & topology) {
+    if (config.transport == "tcp") {
+        InstallTcpOnOff(config, topology);
+    }
+    else if (config.udpApp == "load") {
+        InstallUdpLoad(config, topology);
+    }
+    else {
+        InstallUdpEcho(config, topology);
+    }
+}
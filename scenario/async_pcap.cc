@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cstring>
+#include "async_pcap.h"
+
+using namespace ns3;
+
+
+AsyncPcapWriter::AsyncPcapWriter(const std::string & path, uint32_t dataLinkType, uint32_t snapLen, uint32_t sample, uint32_t bufferBytes, uint32_t buffers)
+    : m_file(std::fopen(path.c_str(), "wb")),
+      m_snapLen(snapLen),
+      m_sample(std::max<uint32_t>(sample, 1)),
+      m_skip(0),
+      // a record never spans two buffers
+      m_bufferBytes(std::max<size_t>(bufferBytes, 16 + size_t(snapLen))),
+      m_buffers(std::max<uint32_t>(buffers, 2)),
+      m_active(0),
+      m_closing(false) {
+    if (!m_file) {
+        NS_FATAL_ERROR("Cannot open pcap file " << path);
+    }
+    for (size_t i = 0; i < m_buffers.size(); ++i) {
+        m_buffers[i].data.reserve(m_bufferBytes);
+        if (i != m_active) {
+            m_free.push_back(i);
+        }
+    }
+
+    // pcap file header
+    uint32_t magic = 0xa1b2c3d4;
+    uint16_t version[2] = { 2, 4 };
+    uint32_t rest[4] = { 0, 0, snapLen, dataLinkType };     // thiszone, sigfigs, snaplen, network
+    std::fwrite(&magic, sizeof(magic), 1, m_file);
+    std::fwrite(version, sizeof(version), 1, m_file);
+    std::fwrite(rest, sizeof(rest), 1, m_file);
+
+    m_thread = std::thread(&AsyncPcapWriter::Run, this);
+}
+
+
+AsyncPcapWriter::~AsyncPcapWriter() {
+    Close();
+}
+
+
+void AsyncPcapWriter::Write(Time t, Ptr<const Packet> p) {
+    if (m_skip > 0) {
+        m_skip--;
+        return;
+    }
+    m_skip = m_sample - 1;
+
+    uint32_t size = p->GetSize();
+    uint32_t captured = std::min(size, m_snapLen);
+    if (m_buffers[m_active].data.size() + 16 + captured > m_bufferBytes) {
+        Flush();
+    }
+
+    uint64_t us = t.GetMicroSeconds();
+    uint32_t record[4] = { uint32_t(us / 1000000), uint32_t(us % 1000000), captured, size };
+    std::vector<uint8_t> & data = m_buffers[m_active].data;
+    size_t used = data.size();
+    data.resize(used + sizeof(record) + captured);      // within the reserved capacity
+    std::memcpy(&data[used], record, sizeof(record));
+    p->CopyData(&data[used + sizeof(record)], captured);
+}
+
+
+/* queue the active buffer and take a free one, waiting for the writer if there is none */
+void AsyncPcapWriter::Flush(void) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_full.push_back(m_active);
+    m_cv.notify_all();
+    m_cv.wait(lock, [this] { return !m_free.empty(); });
+    m_active = m_free.front();
+    m_free.pop_front();
+}
+
+
+void AsyncPcapWriter::Run(void) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [this] { return !m_full.empty() || m_closing; });
+        if (m_full.empty()) {
+            return;
+        }
+        size_t index = m_full.front();
+        m_full.pop_front();
+        lock.unlock();
+        std::fwrite(m_buffers[index].data.data(), 1, m_buffers[index].data.size(), m_file);
+        m_buffers[index].data.clear();
+        lock.lock();
+        m_free.push_back(index);
+        m_cv.notify_all();
+    }
+}
+
+
+void AsyncPcapWriter::Close(void) {
+    if (!m_file) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_buffers[m_active].data.empty()) {
+            m_full.push_back(m_active);
+        }
+        m_closing = true;
+        m_cv.notify_all();
+    }
+    m_thread.join();
+    std::fclose(m_file);
+    m_file = nullptr;
+}
@@ -0,0 +1,65 @@
+#ifndef ASYNC_PCAP_H
+#define ASYNC_PCAP_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+/*
+ * Pcap file written from a background thread.
+ *
+ * Write() runs on the simulator thread and only appends the record header
+ * and the packet bytes to the active buffer. Full buffers are queued, in
+ * order, to a writer thread that does the fwrite; the buffers are
+ * reserved once and cycle between the two threads, so the simulator
+ * only blocks when every buffer is waiting for the disk. A buffer's pages
+ * are only touched as records fill it, so a short capture costs the
+ * bytes it wrote, not bufferBytes * buffers. The file layout
+ * is the one PcapFileWrapper writes (microsecond timestamps, native byte
+ * order), so tcpdump reads both the same way.
+ *
+ * Packets longer than snapLen are cut to their first snapLen bytes, with
+ * the original length kept in the record header. With sample > 1 only
+ * every sample-th packet passed to Write() is recorded, starting with the
+ * first one.
+ */
+class AsyncPcapWriter : public ns3::SimpleRefCount<AsyncPcapWriter> {
+public:
+    AsyncPcapWriter(const std::string & path, uint32_t dataLinkType, uint32_t snapLen = 65535, uint32_t sample = 1, uint32_t bufferBytes = 1 << 20, uint32_t buffers = 4);
+    ~AsyncPcapWriter();
+
+    void Write(ns3::Time t, ns3::Ptr<const ns3::Packet> p);
+
+    /* flush everything still buffered and close the file, idempotent */
+    void Close(void);
+
+private:
+    struct Buffer {
+        std::vector<uint8_t> data;  // the records, capacity m_bufferBytes
+    };
+
+    void Flush(void);
+    void Run(void);
+
+    std::FILE * m_file;
+    uint32_t m_snapLen;
+    uint32_t m_sample;
+    uint32_t m_skip;            // packets left to skip before the next record
+    size_t m_bufferBytes;
+    std::vector<Buffer> m_buffers;
+    size_t m_active;            // buffer the simulator appends to
+    std::deque<size_t> m_full;  // waiting for the writer thread, oldest first
+    std::deque<size_t> m_free;
+    bool m_closing;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+#endif /* ASYNC_PCAP_H */
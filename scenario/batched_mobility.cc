@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cmath>
+#include "batched_mobility.h"
+#include "ns3/assert.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+NS_OBJECT_ENSURE_REGISTERED(BatchedMobilityBlock);
+NS_OBJECT_ENSURE_REGISTERED(BatchedRandomWalk2dMobilityModel);
+
+
+TypeId BatchedMobilityBlock::GetTypeId(void) {
+    static TypeId tid = TypeId("BatchedMobilityBlock")
+        .SetParent<Object>()
+        .AddConstructor<BatchedMobilityBlock>()
+        .AddAttribute("Bounds", "Area the stations walk in",
+                      RectangleValue(Rectangle(0.0, 100.0, 0.0, 100.0)),
+                      MakeRectangleAccessor(&BatchedMobilityBlock::m_bounds),
+                      MakeRectangleChecker())
+        .AddAttribute("SpeedMin", "Lowest speed drawn, meters per second",
+                      DoubleValue(2.0),
+                      MakeDoubleAccessor(&BatchedMobilityBlock::m_speedMin),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("SpeedMax", "Highest speed drawn, meters per second",
+                      DoubleValue(4.0),
+                      MakeDoubleAccessor(&BatchedMobilityBlock::m_speedMax),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("Tick", "Time between two position updates of every station",
+                      TimeValue(MilliSeconds(100)),
+                      MakeTimeAccessor(&BatchedMobilityBlock::m_tick),
+                      MakeTimeChecker())
+        .AddAttribute("ChangeInterval", "Time between two speed and direction draws, as RandomWalk2dMobilityModel's Time",
+                      TimeValue(Seconds(1.0)),
+                      MakeTimeAccessor(&BatchedMobilityBlock::m_changeInterval),
+                      MakeTimeChecker());
+    return tid;
+}
+
+
+BatchedMobilityBlock::BatchedMobilityBlock()
+    : m_speedMin(2.0),
+      m_speedMax(4.0),
+      m_random(CreateObject<UniformRandomVariable>()),
+      m_scheduled(false),
+      m_ticks(0) {
+}
+
+
+BatchedMobilityBlock::~BatchedMobilityBlock() {
+}
+
+
+uint32_t BatchedMobilityBlock::Add(const Vector & position) {
+    m_x.push_back(position.x);
+    m_y.push_back(position.y);
+    m_z.push_back(position.z);
+    m_vx.push_back(0.0);
+    m_vy.push_back(0.0);
+    DrawVelocity(m_x.size() - 1);
+    if (!m_scheduled) {
+        NS_ASSERT(m_tick.IsStrictlyPositive());
+        Simulator::Schedule(m_tick, &BatchedMobilityBlock::Tick, this);
+        m_scheduled = true;
+    }
+    return m_x.size() - 1;
+}
+
+
+Vector BatchedMobilityBlock::GetPosition(uint32_t index) const {
+    return Vector(m_x[index], m_y[index], m_z[index]);
+}
+
+
+void BatchedMobilityBlock::SetPosition(uint32_t index, const Vector & position) {
+    m_x[index] = position.x;
+    m_y[index] = position.y;
+    m_z[index] = position.z;
+}
+
+
+Vector BatchedMobilityBlock::GetVelocity(uint32_t index) const {
+    return Vector(m_vx[index], m_vy[index], 0.0);
+}
+
+
+void BatchedMobilityBlock::DrawVelocity(uint32_t index) {
+    double speed = m_random->GetValue(m_speedMin, m_speedMax);
+    double direction = m_random->GetValue(0.0, 2 * M_PI);
+    m_vx[index] = speed * std::cos(direction);
+    m_vy[index] = speed * std::sin(direction);
+}
+
+
+/* bounce the coordinates that left [low, high] back inside and turn their velocity around */
+static void Reflect(double * position, double * velocity, size_t n, double low, double high) {
+    for (size_t i = 0; i < n; ++i) {
+        double p = position[i];
+        double q = p < low ? 2 * low - p : p;
+        q = q > high ? 2 * high - q : q;
+        position[i] = q;
+        velocity[i] = q == p ? velocity[i] : -velocity[i];
+    }
+}
+
+
+/* one step of every station: a multiply-add over the arrays, which the compiler vectorizes */
+void BatchedMobilityBlock::Tick(void) {
+    double dt = m_tick.GetSeconds();
+    size_t n = m_x.size();
+    double * x = m_x.data();
+    double * y = m_y.data();
+    double * vx = m_vx.data();
+    double * vy = m_vy.data();
+    for (size_t i = 0; i < n; ++i) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+    }
+    // a tick moves a station less than the size of the bounds, one reflection is enough
+    Reflect(x, vx, n, m_bounds.xMin, m_bounds.xMax);
+    Reflect(y, vy, n, m_bounds.yMin, m_bounds.yMax);
+
+    m_ticks++;
+    uint64_t ticksPerChange = std::max<int64_t>(1, m_changeInterval.GetTimeStep() / m_tick.GetTimeStep());
+    if (m_ticks % ticksPerChange == 0) {
+        for (uint32_t i = 0; i < n; ++i) {
+            DrawVelocity(i);
+        }
+    }
+    Simulator::Schedule(m_tick, &BatchedMobilityBlock::Tick, this);
+}
+
+
+TypeId BatchedRandomWalk2dMobilityModel::GetTypeId(void) {
+    static TypeId tid = TypeId("BatchedRandomWalk2dMobilityModel")
+        .SetParent<MobilityModel>()
+        .AddConstructor<BatchedRandomWalk2dMobilityModel>()
+        .AddAttribute("Block", "Block holding the position of this station",
+                      PointerValue(),
+                      MakePointerAccessor(&BatchedRandomWalk2dMobilityModel::m_block),
+                      MakePointerChecker<BatchedMobilityBlock>());
+    return tid;
+}
+
+
+BatchedRandomWalk2dMobilityModel::BatchedRandomWalk2dMobilityModel()
+    : m_index(UINT32_MAX) {
+}
+
+
+BatchedRandomWalk2dMobilityModel::~BatchedRandomWalk2dMobilityModel() {
+}
+
+
+Vector BatchedRandomWalk2dMobilityModel::DoGetPosition(void) const {
+    NS_ASSERT(m_index != UINT32_MAX);
+    return m_block->GetPosition(m_index);
+}
+
+
+/* the first position, from the position allocator, adds the station to the block */
+void BatchedRandomWalk2dMobilityModel::DoSetPosition(const Vector & position) {
+    NS_ASSERT(m_block);
+    if (m_index == UINT32_MAX) {
+        m_index = m_block->Add(position);
+    }
+    else {
+        m_block->SetPosition(m_index, position);
+    }
+}
+
+
+Vector BatchedRandomWalk2dMobilityModel::DoGetVelocity(void) const {
+    NS_ASSERT(m_index != UINT32_MAX);
+    return m_block->GetVelocity(m_index);
+}
@@ -0,0 +1,76 @@
+#ifndef BATCHED_MOBILITY_H
+#define BATCHED_MOBILITY_H
+
+#include <cstdint>
+#include <vector>
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rectangle.h"
+
+/*
+ * Random walk of many stations, all stored in one structure of arrays.
+ *
+ * RandomWalk2dMobilityModel gives every station its own direction change
+ * events and computes the position again on every GetPosition(). Here one
+ * event per Tick moves every station of the block with a plain loop over
+ * the coordinate arrays, bouncing off the Bounds, and every ChangeInterval
+ * all stations draw a new speed and direction from one random stream.
+ * GetPosition() reads the position of the latest tick, at most
+ * SpeedMax * Tick away from the exact one. Directions change on the
+ * ChangeInterval clock rather than after a walked distance, and no
+ * CourseChange is notified.
+ */
+class BatchedMobilityBlock : public ns3::Object {
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    BatchedMobilityBlock();
+    virtual ~BatchedMobilityBlock();
+
+    /* a new station at position, returns its index */
+    uint32_t Add(const ns3::Vector & position);
+    ns3::Vector GetPosition(uint32_t index) const;
+    void SetPosition(uint32_t index, const ns3::Vector & position);
+    ns3::Vector GetVelocity(uint32_t index) const;
+
+private:
+    void DrawVelocity(uint32_t index);
+    void Tick(void);
+
+    ns3::Rectangle m_bounds;
+    double m_speedMin;              // meters per second
+    double m_speedMax;
+    ns3::Time m_tick;
+    ns3::Time m_changeInterval;
+    ns3::Ptr<ns3::UniformRandomVariable> m_random;
+    bool m_scheduled;
+    uint64_t m_ticks;
+
+    // station i is x[i], y[i], z[i] moving at vx[i], vy[i]
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+    std::vector<double> m_vx;
+    std::vector<double> m_vy;
+};
+
+
+/* one station of a BatchedMobilityBlock */
+class BatchedRandomWalk2dMobilityModel : public ns3::MobilityModel {
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    BatchedRandomWalk2dMobilityModel();
+    virtual ~BatchedRandomWalk2dMobilityModel();
+
+private:
+    virtual ns3::Vector DoGetPosition(void) const;
+    virtual void DoSetPosition(const ns3::Vector & position);
+    virtual ns3::Vector DoGetVelocity(void) const;
+
+    ns3::Ptr<BatchedMobilityBlock> m_block;
+    uint32_t m_index;
+};
+
+#endif /* BATCHED_MOBILITY_H */
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include "dary_heap_scheduler.h"
+#include "ns3/assert.h"
+
+using namespace ns3;
+
+NS_OBJECT_ENSURE_REGISTERED(DaryHeapScheduler);
+
+
+TypeId DaryHeapScheduler::GetTypeId(void) {
+    static TypeId tid = TypeId("DaryHeapScheduler")
+        .SetParent<Scheduler>()
+        .AddConstructor<DaryHeapScheduler>();
+    return tid;
+}
+
+
+DaryHeapScheduler::DaryHeapScheduler() {
+}
+
+
+DaryHeapScheduler::~DaryHeapScheduler() {
+}
+
+
+/* move the event at index up until its parent is earlier */
+void DaryHeapScheduler::SiftUp(size_t index) {
+    Event ev = m_heap[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / ARITY;
+        if (!(ev.key < m_heap[parent].key)) {
+            break;
+        }
+        m_heap[index] = m_heap[parent];
+        index = parent;
+    }
+    m_heap[index] = ev;
+}
+
+
+/* move the event at index down until all its children are later */
+void DaryHeapScheduler::SiftDown(size_t index) {
+    size_t size = m_heap.size();
+    Event ev = m_heap[index];
+    while (true) {
+        size_t first = index * ARITY + 1;
+        if (first >= size) {
+            break;
+        }
+        size_t last = std::min(first + ARITY, size);
+        size_t earliest = first;
+        for (size_t child = first + 1; child < last; ++child) {
+            if (m_heap[child].key < m_heap[earliest].key) {
+                earliest = child;
+            }
+        }
+        if (!(m_heap[earliest].key < ev.key)) {
+            break;
+        }
+        m_heap[index] = m_heap[earliest];
+        index = earliest;
+    }
+    m_heap[index] = ev;
+}
+
+
+void DaryHeapScheduler::Insert(const Event & ev) {
+    m_heap.push_back(ev);
+    SiftUp(m_heap.size() - 1);
+}
+
+
+bool DaryHeapScheduler::IsEmpty(void) const {
+    return m_heap.empty();
+}
+
+
+Scheduler::Event DaryHeapScheduler::PeekNext(void) const {
+    NS_ASSERT(!m_heap.empty());
+    return m_heap.front();
+}
+
+
+Scheduler::Event DaryHeapScheduler::RemoveNext(void) {
+    NS_ASSERT(!m_heap.empty());
+    Event next = m_heap.front();
+    m_heap.front() = m_heap.back();
+    m_heap.pop_back();
+    if (!m_heap.empty()) {
+        SiftDown(0);
+    }
+    return next;
+}
+
+
+void DaryHeapScheduler::Remove(const Event & ev) {
+    for (size_t i = 0; i < m_heap.size(); ++i) {
+        if (m_heap[i].key.m_uid != ev.key.m_uid) {
+            continue;
+        }
+        NS_ASSERT(m_heap[i].impl == ev.impl);
+        m_heap[i] = m_heap.back();
+        m_heap.pop_back();
+        if (i < m_heap.size()) {
+            // the moved event can belong above or below its new slot
+            SiftUp(i);
+            SiftDown(i);
+        }
+        return;
+    }
+    NS_ASSERT_MSG(false, "Event not found");
+}
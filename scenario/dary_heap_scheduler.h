@@ -0,0 +1,40 @@
+#ifndef DARY_HEAP_SCHEDULER_H
+#define DARY_HEAP_SCHEDULER_H
+
+#include <cstddef>
+#include <vector>
+#include "ns3/scheduler.h"
+
+/*
+ * Event set kept as an implicit 4-ary min-heap in one vector.
+ *
+ * The four children of a node are adjacent, so sifting down touches one
+ * or two cache lines per level, and the tree is half as deep as the
+ * binary ns3::HeapScheduler's. Events are ordered by (timestamp, uid) like
+ * in every ns-3 scheduler, so a run gives the same results as with the
+ * default map scheduler. Remove() of a cancelled event is a linear search,
+ * as in HeapScheduler.
+ */
+class DaryHeapScheduler : public ns3::Scheduler {
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    DaryHeapScheduler();
+    virtual ~DaryHeapScheduler();
+
+    virtual void Insert(const Event & ev);
+    virtual bool IsEmpty(void) const;
+    virtual Event PeekNext(void) const;
+    virtual Event RemoveNext(void);
+    virtual void Remove(const Event & ev);
+
+private:
+    static const size_t ARITY = 4;
+
+    void SiftUp(size_t index);
+    void SiftDown(size_t index);
+
+    std::vector<Event> m_heap;
+};
+
+#endif /* DARY_HEAP_SCHEDULER_H */
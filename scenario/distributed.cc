@@ -0,0 +1,67 @@
+#include "scenario.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
+
+using namespace ns3;
+
+// --distributed=true: two MPI ranks, the sender side (n0 and the sender
+// access network) on rank 0 and the receiver side (n1 and the receiver
+// access network) on rank 1. The p2p link between n0 and n1 is the only
+// link that crosses ranks, so its delay is the lookahead.
+//
+//   mpirun -np 2 build/scratch/scenario/scenario --distributed=true --sender=csma --receiver=csma
+
+
+void EnableDistributed(const ScenarioConfig & config, int * argc, char *** argv) {
+    if (!config.distributed) {
+        return;
+    }
+#ifdef NS3_MPI
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DistributedSimulatorImpl"));
+    MpiInterface::Enable(argc, argv);
+    if (MpiInterface::GetSize() != 2) {
+        NS_FATAL_ERROR("--distributed needs exactly 2 ranks (mpirun -np 2), got " << MpiInterface::GetSize());
+    }
+#else
+    NS_FATAL_ERROR("--distributed needs ns-3 configured with --enable-mpi");
+#endif
+}
+
+
+void DisableDistributed(const ScenarioConfig & config) {
+#ifdef NS3_MPI
+    if (config.distributed) {
+        MpiInterface::Disable();
+    }
+#endif
+}
+
+
+uint32_t Rank(void) {
+#ifdef NS3_MPI
+    return MpiInterface::IsEnabled() ? MpiInterface::GetSystemId() : 0;
+#else
+    return 0;
+#endif
+}
+
+
+uint32_t SenderRank(const ScenarioConfig & config) {
+    return 0;
+}
+
+
+uint32_t ReceiverRank(const ScenarioConfig & config) {
+    return config.distributed ? 1 : 0;
+}
+
+
+bool IsLocal(Ptr<Node> node) {
+    return node->GetSystemId() == Rank();
+}
+
+
+std::string RankSuffix(const ScenarioConfig & config) {
+    return config.distributed ? "_rank" + std::to_string(Rank()) : "";
+}
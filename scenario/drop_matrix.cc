@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "drop_matrix.h"
+#include "scenario.h"
+#include "ns3/csma-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/traffic-control-module.h"
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+using namespace ns3;
+
+
+DropMatrix::DropMatrix() {
+}
+
+
+void DropMatrix::Count(uint32_t site, uint32_t column) {
+    m_counts[size_t(site) * DROP_COLUMNS + column]++;
+}
+
+
+std::string DropMatrix::ColumnLayer(uint32_t column) {
+    if (column >= PHY_WIFI_RX || column <= PHY_WIFI_TX) {
+        return "phy";
+    }
+    if (column <= MAC_RETRY_LIMIT) {
+        return "mac";
+    }
+    if (column <= QUEUE_EXPIRED) {
+        return "queue";
+    }
+    if (column <= TC_DEQUEUE) {
+        return "tc";
+    }
+    return "ip";
+}
+
+
+std::string DropMatrix::ColumnReason(uint32_t column) {
+    static const char * names[] = { "rxError", "txFailed", "wifiTx", "txDrop", "rxDrop", "retryLimit", "overflow",
+                                    "expired", "enqueue", "dequeue", "ttlExpired", "noRoute", "badChecksum", "interfaceDown",
+                                    "routeError", "fragmentTimeout" };
+    if (column < PHY_WIFI_RX) {
+        return names[column];
+    }
+    std::ostringstream name;
+    name << "wifiRx " << WifiPhyRxfailureReason(column - PHY_WIFI_RX);
+    return name.str();
+}
+
+
+void DropMatrix::PhyDrop(DropMatrix * matrix, uint32_t site, uint32_t column, Ptr<const Packet> p) {
+    matrix->Count(site, column);
+}
+
+
+void DropMatrix::MacTxDrop(DropMatrix * matrix, uint32_t site, Ptr<const Packet> p) {
+    if (matrix->m_sites[site].lastQueueDrop != p->GetUid()) {
+        matrix->Count(site, MAC_TX_DROP);
+    }
+}
+
+
+void DropMatrix::QueueDrop(DropMatrix * matrix, uint32_t site, Ptr<const Packet> p) {
+    matrix->m_sites[site].lastQueueDrop = p->GetUid();
+    matrix->Count(site, QUEUE_OVERFLOW);
+}
+
+
+void DropMatrix::WifiQueueDrop(DropMatrix * matrix, uint32_t site, uint32_t column, Ptr<const WifiMacQueueItem> item) {
+    matrix->Count(site, column);
+}
+
+
+void DropMatrix::WifiRxDrop(DropMatrix * matrix, uint32_t site, Ptr<const Packet> p, WifiPhyRxfailureReason reason) {
+    matrix->Count(site, PHY_WIFI_RX + std::min<uint32_t>(reason, DROP_COLUMNS - PHY_WIFI_RX - 1));
+}
+
+
+void DropMatrix::RetryLimit(DropMatrix * matrix, uint32_t site, Mac48Address address) {
+    matrix->Count(site, MAC_RETRY_LIMIT);
+}
+
+
+void DropMatrix::QueueDiscDrop(DropMatrix * matrix, uint32_t site, uint32_t column, Ptr<const QueueDiscItem> item, const char * reason) {
+    matrix->Count(site, column);
+}
+
+
+/* the sites of a node are consecutive in device order */
+void DropMatrix::IpDrop(DropMatrix * matrix, uint32_t firstSite, const Ipv4Header & header, Ptr<const Packet> p,
+                        Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface) {
+    uint32_t device = interface < ipv4->GetNInterfaces() ? ipv4->GetNetDevice(interface)->GetIfIndex() : 0;
+    matrix->Count(firstSite + device, IP_TTL_EXPIRED + std::min<uint32_t>(reason - Ipv4L3Protocol::DROP_TTL_EXPIRED, IP_FRAGMENT_TIMEOUT - IP_TTL_EXPIRED));
+}
+
+
+void DropMatrix::ConnectDevice(uint32_t site, Ptr<NetDevice> device) {
+    Ptr<Queue<Packet> > queue;
+    if (Ptr<PointToPointNetDevice> p2p = DynamicCast<PointToPointNetDevice>(device)) {
+        queue = p2p->GetQueue();
+    }
+    else if (Ptr<CsmaNetDevice> csma = DynamicCast<CsmaNetDevice>(device)) {
+        queue = csma->GetQueue();
+    }
+    else if (Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice>(device)) {
+        wifi->GetPhy()->TraceConnectWithoutContext("PhyTxDrop", MakeBoundCallback(&DropMatrix::PhyDrop, this, site, uint32_t(PHY_WIFI_TX)));
+        wifi->GetPhy()->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&DropMatrix::WifiRxDrop, this, site));
+        wifi->GetMac()->TraceConnectWithoutContext("MacTxDrop", MakeBoundCallback(&DropMatrix::MacTxDrop, this, site));
+        wifi->GetMac()->TraceConnectWithoutContext("MacRxDrop", MakeBoundCallback(&DropMatrix::PhyDrop, this, site, uint32_t(MAC_RX_DROP)));
+        wifi->GetRemoteStationManager()->TraceConnectWithoutContext("MacTxFinalDataFailed", MakeBoundCallback(&DropMatrix::RetryLimit, this, site));
+        // the DCF queue, and the EDCA ones of a QoS MAC; packets past their
+        // lifetime leave them through Expired, not Drop
+        for (const char * name : { "Txop", "VO_Txop", "VI_Txop", "BE_Txop", "BK_Txop" }) {
+            PointerValue txop;
+            if (wifi->GetMac()->GetAttributeFailSafe(name, txop) && txop.Get<Txop>()) {
+                Ptr<WifiMacQueue> macQueue = txop.Get<Txop>()->GetWifiMacQueue();
+                macQueue->TraceConnectWithoutContext("Drop", MakeBoundCallback(&DropMatrix::WifiQueueDrop, this, site, uint32_t(QUEUE_OVERFLOW)));
+                macQueue->TraceConnectWithoutContext("Expired", MakeBoundCallback(&DropMatrix::WifiQueueDrop, this, site, uint32_t(QUEUE_EXPIRED)));
+            }
+        }
+    }
+    else {
+        return;
+    }
+    if (queue) {
+        queue->TraceConnectWithoutContext("Drop", MakeBoundCallback(&DropMatrix::QueueDrop, this, site));
+        device->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&DropMatrix::PhyDrop, this, site, uint32_t(PHY_RX_ERROR)));
+        device->TraceConnectWithoutContext("PhyTxDrop", MakeBoundCallback(&DropMatrix::PhyDrop, this, site, uint32_t(PHY_TX_FAILED)));
+        device->TraceConnectWithoutContext("MacTxDrop", MakeBoundCallback(&DropMatrix::MacTxDrop, this, site));
+    }
+    Ptr<TrafficControlLayer> tc = device->GetNode()->GetObject<TrafficControlLayer>();
+    Ptr<QueueDisc> queueDisc = tc ? tc->GetRootQueueDiscOnDevice(device) : 0;
+    if (queueDisc) {
+        queueDisc->TraceConnectWithoutContext("DropBeforeEnqueue", MakeBoundCallback(&DropMatrix::QueueDiscDrop, this, site, uint32_t(TC_ENQUEUE)));
+        queueDisc->TraceConnectWithoutContext("DropAfterDequeue", MakeBoundCallback(&DropMatrix::QueueDiscDrop, this, site, uint32_t(TC_DEQUEUE)));
+    }
+}
+
+
+static const char * DeviceType(Ptr<NetDevice> device) {
+    if (DynamicCast<PointToPointNetDevice>(device)) {
+        return "p2p";
+    }
+    if (DynamicCast<CsmaNetDevice>(device)) {
+        return "csma";
+    }
+    if (DynamicCast<WifiNetDevice>(device)) {
+        return "wifi";
+    }
+    return "other";
+}
+
+
+/* every rank holds every node, so the rows are the same on every rank */
+void DropMatrix::Install(void) {
+    for (uint32_t n = 0; n < NodeList::GetNNodes(); ++n) {
+        Ptr<Node> node = NodeList::GetNode(n);
+        uint32_t firstSite = m_sites.size();
+        for (uint32_t d = 0; d < node->GetNDevices(); ++d) {
+            Site s;
+            s.node = node->GetId();
+            s.device = d;
+            s.type = DeviceType(node->GetDevice(d));
+            s.lastQueueDrop = ~uint64_t(0);
+            m_sites.push_back(s);
+        }
+        if (!IsLocal(node)) {
+            continue;
+        }
+        for (uint32_t d = 0; d < node->GetNDevices(); ++d) {
+            ConnectDevice(firstSite + d, node->GetDevice(d));
+        }
+        Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol>();
+        if (ipv4) {
+            ipv4->TraceConnectWithoutContext("Drop", MakeBoundCallback(&DropMatrix::IpDrop, this, firstSite));
+        }
+    }
+    m_counts.assign(m_sites.size() * DROP_COLUMNS, 0);
+}
+
+
+void DropMatrix::Write(const std::string & path) const {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        NS_FATAL_ERROR("Cannot open drop matrix file " << path);
+    }
+    out << "node,device,type,layer,reason,drops\n";
+    for (size_t site = 0; site < m_sites.size(); ++site) {
+        const Site & s = m_sites[site];
+        for (uint32_t column = 0; column < DROP_COLUMNS; ++column) {
+            uint64_t drops = m_counts[site * DROP_COLUMNS + column];
+            if (drops > 0) {
+                out << s.node << "," << s.device << "," << s.type << "," << ColumnLayer(column) << "," << ColumnReason(column) << "," << drops << "\n";
+            }
+        }
+    }
+}
+
+
+/* --verbose=stats: the non zero columns, most drops first */
+void DropMatrix::Print(void) const {
+    struct Line {
+        uint32_t column;
+        uint64_t drops;
+        uint32_t devices;
+        size_t top;
+    };
+    std::vector<Line> lines;
+    for (uint32_t column = 0; column < DROP_COLUMNS; ++column) {
+        Line line = { column, 0, 0, 0 };
+        for (size_t site = 0; site < m_sites.size(); ++site) {
+            uint64_t drops = m_counts[site * DROP_COLUMNS + column];
+            if (drops > 0) {
+                line.drops += drops;
+                line.devices++;
+                if (drops > m_counts[line.top * DROP_COLUMNS + column]) {
+                    line.top = site;
+                }
+            }
+        }
+        if (line.drops > 0) {
+            lines.push_back(line);
+        }
+    }
+    std::stable_sort(lines.begin(), lines.end(), [](const Line & a, const Line & b) { return a.drops > b.drops; });
+
+    std::cout << std::left << std::setw(7) << "layer" << std::setw(36) << "reason"
+              << std::right << std::setw(10) << "drops" << std::setw(9) << "devices" << "  most at\n";
+    for (const Line & line : lines) {
+        const Site & top = m_sites[line.top];
+        std::cout << std::left << std::setw(7) << ColumnLayer(line.column) << std::setw(36) << ColumnReason(line.column)
+                  << std::right << std::setw(10) << line.drops << std::setw(9) << line.devices
+                  << "  node " << top.node << " device " << top.device << " (" << top.type << ") "
+                  << m_counts[line.top * DROP_COLUMNS + line.column] << "\n";
+    }
+}
+
+
+void DropMatrix::Reduce(void) {
+#ifdef NS3_MPI
+    MPI_Allreduce(MPI_IN_PLACE, m_counts.data(), int(m_counts.size()), MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+#endif
+}
@@ -0,0 +1,87 @@
+#ifndef DROP_MATRIX_H
+#define DROP_MATRIX_H
+
+#include <string>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/wifi-module.h"
+
+/* columns of the drop matrix, a layer and a reason each */
+enum DropColumn {
+    PHY_RX_ERROR,           // p2p, csma PhyRxDrop: error model, receiver disabled
+    PHY_TX_FAILED,          // p2p, csma PhyTxDrop
+    PHY_WIFI_TX,            // WifiPhy PhyTxDrop
+    MAC_TX_DROP,            // MacTxDrop not counted as a device queue overflow
+    MAC_RX_DROP,            // WifiMac MacRxDrop
+    MAC_RETRY_LIMIT,        // WifiRemoteStationManager MacTxFinalDataFailed
+    QUEUE_OVERFLOW,         // device queue Drop, WifiMacQueue Drop
+    QUEUE_EXPIRED,          // WifiMacQueue Expired: lifetime (MaxDelay) exceeded
+    TC_ENQUEUE,             // root QueueDisc DropBeforeEnqueue
+    TC_DEQUEUE,             // root QueueDisc DropAfterDequeue
+    IP_TTL_EXPIRED,         // Ipv4L3Protocol Drop, in DropReason order
+    IP_NO_ROUTE,
+    IP_BAD_CHECKSUM,
+    IP_INTERFACE_DOWN,
+    IP_ROUTE_ERROR,
+    IP_FRAGMENT_TIMEOUT,
+    PHY_WIFI_RX,            // WifiPhy PhyRxDrop, one column per WifiPhyRxfailureReason
+    DROP_COLUMNS = PHY_WIFI_RX + 32
+};
+
+
+/*
+ * Drop counters of every device of every node, by layer and reason.
+ *
+ * Install() connects every drop trace source of the topology: PHY, MAC and
+ * device queue of the p2p, csma and wifi devices, the traffic control root
+ * queue disc and the IPv4 layer (charged to the interface's device). The
+ * counters are one matrix, a row per device and a column per DropColumn,
+ * allocated once; a drop is an increment. A device queue overflow fires the
+ * queue's Drop and then the device's MacTxDrop, it is counted once.
+ */
+class DropMatrix {
+public:
+    DropMatrix();
+
+    /* after the internet stack: every node and device of NodeList, the
+       trace sources of the local ones */
+    void Install(void);
+
+    /* node,device,type,layer,reason,drops, the non zero cells */
+    void Write(const std::string & path) const;
+    /* a line per non zero column: drops, devices, the device with the most */
+    void Print(void) const;
+
+    /* --distributed: sum the counters of every rank (MPI collective) */
+    void Reduce(void);
+
+private:
+    struct Site {
+        uint32_t node;
+        uint32_t device;
+        std::string type;
+        uint64_t lastQueueDrop;     // uid, a MacTxDrop of it is the same drop
+    };
+
+    void Count(uint32_t site, uint32_t column);
+    void ConnectDevice(uint32_t site, ns3::Ptr<ns3::NetDevice> device);
+    static std::string ColumnLayer(uint32_t column);
+    static std::string ColumnReason(uint32_t column);
+
+    static void PhyDrop(DropMatrix * matrix, uint32_t site, uint32_t column, ns3::Ptr<const ns3::Packet> p);
+    static void MacTxDrop(DropMatrix * matrix, uint32_t site, ns3::Ptr<const ns3::Packet> p);
+    static void QueueDrop(DropMatrix * matrix, uint32_t site, ns3::Ptr<const ns3::Packet> p);
+    static void WifiQueueDrop(DropMatrix * matrix, uint32_t site, uint32_t column, ns3::Ptr<const ns3::WifiMacQueueItem> item);
+    static void WifiRxDrop(DropMatrix * matrix, uint32_t site, ns3::Ptr<const ns3::Packet> p, ns3::WifiPhyRxfailureReason reason);
+    static void RetryLimit(DropMatrix * matrix, uint32_t site, ns3::Mac48Address address);
+    static void QueueDiscDrop(DropMatrix * matrix, uint32_t site, uint32_t column, ns3::Ptr<const ns3::QueueDiscItem> item, const char * reason);
+    static void IpDrop(DropMatrix * matrix, uint32_t firstSite, const ns3::Ipv4Header & header, ns3::Ptr<const ns3::Packet> p,
+                       ns3::Ipv4L3Protocol::DropReason reason, ns3::Ptr<ns3::Ipv4> ipv4, uint32_t interface);
+
+    std::vector<Site> m_sites;
+    std::vector<uint64_t> m_counts;     // site * DROP_COLUMNS + column
+};
+
+#endif /* DROP_MATRIX_H */
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <fstream>
+#include "drop_stats.h"
+#include "ns3/csma-module.h"
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+using namespace ns3;
+
+
+const char * DropSiteName(DropSite site) {
+    switch (site) {
+    case RECEIVER_DROP:
+        return "receiver";
+    case INTER_DROP:
+        return "inter";
+    }
+    return "unknown";
+}
+
+
+const uint32_t DropStats::MAX_BINS;
+
+
+DropStats::DropStats(Time binWidth, Time stopTime)
+    : m_binWidth(std::max<int64_t>(binWidth.GetTimeStep(), 1)),
+      m_bins(0) {
+    int64_t bins = stopTime.GetTimeStep() / m_binWidth + 1;
+    if (binWidth.IsStrictlyNegative() || binWidth.IsZero() || bins > int64_t(MAX_BINS)) {
+        NS_FATAL_ERROR("Drop stats bin width " << binWidth.GetSeconds() << " s gives " << bins << " bins up to "
+                       << stopTime.GetSeconds() << " s, at most " << MAX_BINS);
+    }
+    m_bins = uint32_t(bins);
+}
+
+
+void DropStats::AddSite(DropSite site, Ptr<NetDevice> device) {
+    uint32_t index = m_sites.size();
+    Site s;
+    s.site = site;
+    s.node = device->GetNode()->GetId();
+    s.device = device->GetIfIndex();
+    s.csma = DynamicCast<CsmaNetDevice>(device) != 0;
+    s.address = Mac48Address::ConvertFrom(device->GetAddress());
+    s.arrivals = 0;
+    s.drops = 0;
+    s.binArrivals.assign(m_bins, 0);
+    s.binDrops.assign(m_bins, 0);
+    m_sites.push_back(s);
+
+    device->TraceConnectWithoutContext("MacRx", MakeBoundCallback(&DropStats::Arrival, this, index));
+    device->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&DropStats::Drop, this, index));
+}
+
+
+uint32_t DropStats::Bin(void) const {
+    uint64_t bin = Simulator::Now().GetTimeStep() / m_binWidth;
+    return bin < m_bins ? uint32_t(bin) : m_bins - 1;
+}
+
+
+/* packets that made it through the error model */
+void DropStats::Arrival(DropStats * stats, uint32_t site, Ptr<const Packet> p) {
+    Site & s = stats->m_sites[site];
+    s.arrivals++;
+    s.binArrivals[stats->Bin()]++;
+}
+
+
+/* a csma frame still has its Ethernet header here, before the address filter */
+void DropStats::Drop(DropStats * stats, uint32_t site, Ptr<const Packet> p) {
+    Site & s = stats->m_sites[site];
+    if (s.csma) {
+        EthernetHeader header(false);
+        p->PeekHeader(header);
+        Mac48Address destination = header.GetDestination();
+        if (destination != s.address && !destination.IsBroadcast() && !destination.IsGroup()) {
+            return;
+        }
+    }
+    s.arrivals++;
+    s.drops++;
+    uint32_t bin = stats->Bin();
+    s.binArrivals[bin]++;
+    s.binDrops[bin]++;
+}
+
+
+uint64_t DropStats::GetArrivals(void) const {
+    uint64_t arrivals = 0;
+    for (const Site & s : m_sites) {
+        arrivals += s.arrivals;
+    }
+    return arrivals;
+}
+
+
+uint64_t DropStats::GetDrops(DropSite site) const {
+    uint64_t drops = 0;
+    for (const Site & s : m_sites) {
+        if (s.site == site) {
+            drops += s.drops;
+        }
+    }
+    return drops;
+}
+
+
+void DropStats::Write(const std::string & path) const {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        NS_FATAL_ERROR("Cannot open drop stats file " << path);
+    }
+    double binSeconds = Time(m_binWidth).GetSeconds();
+    out << "site,node,device,bin,startSeconds,arrivals,drops,lossRate\n";
+    for (const Site & s : m_sites) {
+        for (uint32_t bin = 0; bin < m_bins; ++bin) {
+            if (s.binArrivals[bin] == 0) {
+                continue;
+            }
+            out << DropSiteName(s.site) << "," << s.node << "," << s.device << ","
+                << bin << "," << bin * binSeconds << ","
+                << s.binArrivals[bin] << "," << s.binDrops[bin] << ","
+                << double(s.binDrops[bin]) / s.binArrivals[bin] << "\n";
+        }
+        out << DropSiteName(s.site) << "," << s.node << "," << s.device << ",total,0,"
+            << s.arrivals << "," << s.drops << ","
+            << (s.arrivals > 0 ? double(s.drops) / s.arrivals : 0.0) << "\n";
+    }
+}
+
+
+void DropStats::Reduce(void) {
+#ifdef NS3_MPI
+    for (Site & s : m_sites) {
+        uint64_t totals[] = { s.arrivals, s.drops };
+        MPI_Allreduce(MPI_IN_PLACE, totals, 2, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+        s.arrivals = totals[0];
+        s.drops = totals[1];
+        MPI_Allreduce(MPI_IN_PLACE, s.binArrivals.data(), m_bins, MPI_UINT32_T, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, s.binDrops.data(), m_bins, MPI_UINT32_T, MPI_SUM, MPI_COMM_WORLD);
+    }
+#endif
+}
@@ -0,0 +1,72 @@
+#ifndef DROP_STATS_H
+#define DROP_STATS_H
+
+#include <string>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+/* error-model devices, resolved once when the trace sources are connected */
+enum DropSite {
+    RECEIVER_DROP,      // receiver device
+    INTER_DROP          // p2p devices between the access networks
+};
+
+/* receiver, inter */
+const char * DropSiteName(DropSite site);
+
+
+/*
+ * In-process loss accounting for the error-model devices.
+ *
+ * Each drop site (a device with a ReceiveErrorModel) keeps a total and a
+ * fixed number of time bins of arrivals (MacRx + PhyRxDrop) and drops.
+ * A csma device's PhyRxDrop also sees the frames for the other hosts of
+ * the LAN, which MacRx never reports; those drops are not counted.
+ * Bins are allocated once, before the simulation starts; later drops fall
+ * into the last bin. Write() produces one csv with a row per site and bin
+ * plus a total row per site, which replaces the drop pcap + tcpdump step.
+ */
+class DropStats {
+public:
+    /* bins per site allocated up front, 8 bytes each */
+    static const uint32_t MAX_BINS = 1000000;
+
+    /* binWidth positive, stopTime / binWidth below MAX_BINS */
+    DropStats(ns3::Time binWidth, ns3::Time stopTime);
+
+    /* hook MacRx and PhyRxDrop of device, reported under site */
+    void AddSite(DropSite site, ns3::Ptr<ns3::NetDevice> device);
+
+    uint64_t GetArrivals(void) const;
+    uint64_t GetDrops(DropSite site) const;
+
+    void Write(const std::string & path) const;
+
+    /* --distributed: sum the counters of every rank (MPI collective); a
+       site only counts on the rank that owns its device */
+    void Reduce(void);
+
+private:
+    struct Site {
+        DropSite site;
+        uint32_t node;
+        uint32_t device;
+        bool csma;
+        ns3::Mac48Address address;
+        uint64_t arrivals;
+        uint64_t drops;
+        std::vector<uint32_t> binArrivals;
+        std::vector<uint32_t> binDrops;
+    };
+
+    uint32_t Bin(void) const;
+    static void Arrival(DropStats * stats, uint32_t site, ns3::Ptr<const ns3::Packet> p);
+    static void Drop(DropStats * stats, uint32_t site, ns3::Ptr<const ns3::Packet> p);
+
+    int64_t m_binWidth;     // time steps per bin
+    uint32_t m_bins;
+    std::vector<Site> m_sites;
+};
+
+#endif /* DROP_STATS_H */
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <cxxabi.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "event_profiler.h"
+#include "ns3/event-impl.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+NS_OBJECT_ENSURE_REGISTERED(ProfilingScheduler);
+
+
+static int64_t SteadyNanoseconds(void) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/* the cheapest monotonic counter of the cpu, converted to time at the report */
+static inline uint64_t Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return SteadyNanoseconds();
+#endif
+}
+
+
+/*
+ * The event the simulator runs instead of the scheduled one. It takes over
+ * the scheduler's reference to the scheduled event, and is allocated from
+ * a free list, as one is made for every event.
+ */
+class ProfiledEvent : public EventImpl {
+public:
+    ProfiledEvent(EventImpl * event, ProfilingScheduler::Handler * handler, uint64_t * lastEnd)
+        : m_event(event),
+          m_handler(handler),
+          m_lastEnd(lastEnd) {
+    }
+
+    virtual ~ProfiledEvent() {
+        m_event->Unref();
+    }
+
+    static void * operator new(size_t size) {
+        if (size != sizeof(ProfiledEvent) || s_free.empty()) {
+            return ::operator new(size);
+        }
+        void * memory = s_free.back();
+        s_free.pop_back();
+        return memory;
+    }
+
+    static void operator delete(void * memory) {
+        s_free.push_back(memory);
+    }
+
+private:
+    virtual void Notify(void) {
+        uint64_t start = Cycles();
+        m_event->Invoke();
+        uint64_t end = Cycles();
+        uint64_t cycles = end - start;
+        m_handler->events++;
+        m_handler->cycles += cycles;
+        m_handler->histogram[cycles == 0 ? 0 : 63 - __builtin_clzll(cycles)]++;
+        *m_lastEnd = end;
+    }
+
+    EventImpl * m_event;
+    ProfilingScheduler::Handler * m_handler;
+    uint64_t * m_lastEnd;
+
+    static std::vector<void *> s_free;
+};
+
+std::vector<void *> ProfiledEvent::s_free;
+
+
+TypeId ProfilingScheduler::GetTypeId(void) {
+    static TypeId tid = TypeId("ProfilingScheduler")
+        .SetParent<Scheduler>()
+        .AddConstructor<ProfilingScheduler>()
+        .AddAttribute("Scheduler", "Scheduler that keeps the events",
+                      TypeIdValue(MapScheduler::GetTypeId()),
+                      MakeTypeIdAccessor(&ProfilingScheduler::m_schedulerType),
+                      MakeTypeIdChecker())
+        .AddAttribute("Rows", "Handler types printed at Simulator::Destroy",
+                      UintegerValue(20),
+                      MakeUintegerAccessor(&ProfilingScheduler::m_rows),
+                      MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+
+ProfilingScheduler::ProfilingScheduler()
+    : m_rows(20),
+      m_lastType(0),
+      m_lastHandler(0),
+      m_cancelled(0),
+      m_firstStart(0),
+      m_lastEnd(0),
+      m_startCycles(Cycles()),
+      m_startNanoseconds(SteadyNanoseconds()) {
+}
+
+
+ProfilingScheduler::~ProfilingScheduler() {
+}
+
+
+void ProfilingScheduler::NotifyConstructionCompleted(void) {
+    ObjectFactory factory;
+    factory.SetTypeId(m_schedulerType);
+    m_scheduler = factory.Create<Scheduler>();
+    Simulator::ScheduleDestroy(&ProfilingScheduler::Report, Ptr<ProfilingScheduler>(this));
+    Scheduler::NotifyConstructionCompleted();
+}
+
+
+void ProfilingScheduler::DoDispose(void) {
+    m_scheduler = 0;
+    Scheduler::DoDispose();
+}
+
+
+void ProfilingScheduler::Insert(const Event & ev) {
+    m_scheduler->Insert(ev);
+}
+
+
+bool ProfilingScheduler::IsEmpty(void) const {
+    return m_scheduler->IsEmpty();
+}
+
+
+Scheduler::Event ProfilingScheduler::PeekNext(void) const {
+    return m_scheduler->PeekNext();
+}
+
+
+Scheduler::Event ProfilingScheduler::RemoveNext(void) {
+    Event ev = m_scheduler->RemoveNext();
+    if (ev.impl->IsCancelled()) {
+        m_cancelled++;
+        return ev;
+    }
+    const std::type_info * type = &typeid(*ev.impl);
+    if (type != m_lastType) {
+        m_lastType = type;
+        m_lastHandler = &m_handlers[type];
+    }
+    if (m_firstStart == 0) {
+        m_firstStart = Cycles();
+    }
+    ev.impl = new ProfiledEvent(ev.impl, m_lastHandler, &m_lastEnd);
+    return ev;
+}
+
+
+void ProfilingScheduler::Remove(const Event & ev) {
+    m_scheduler->Remove(ev);
+}
+
+
+/* demangled handler type without ns3::, MakeEvent's local classes by its template arguments */
+static std::string HandlerName(const std::type_info & type) {
+    int status = 0;
+    char * demangled = abi::__cxa_demangle(type.name(), 0, 0, &status);
+    std::string name = status == 0 ? demangled : type.name();
+    std::free(demangled);
+    for (size_t ns; (ns = name.find("ns3::")) != std::string::npos; ) {
+        name.erase(ns, 5);
+    }
+    size_t make = name.find("MakeEvent<");
+    if (make != std::string::npos) {
+        size_t begin = make + 10;
+        size_t end = begin;
+        for (int depth = 1; end < name.size() && depth > 0; ++end) {
+            depth += name[end] == '<' ? 1 : name[end] == '>' ? -1 : 0;
+        }
+        name = "MakeEvent<" + name.substr(begin, end - begin - 1) + ">";
+    }
+    return name;
+}
+
+
+/* upper bound of the histogram bucket holding the q quantile, 0 without events */
+static uint64_t Quantile(const ProfilingScheduler::Handler & handler, double q) {
+    if (handler.events == 0) {
+        return 0;
+    }
+    uint64_t rank = uint64_t(q * (handler.events - 1));
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < 64; ++bucket) {
+        seen += handler.histogram[bucket];
+        if (seen > rank) {
+            return bucket == 63 ? UINT64_MAX : (uint64_t(2) << bucket) - 1;
+        }
+    }
+    return 0;
+}
+
+
+void ProfilingScheduler::Report(void) {
+    // one row per name, the same local class can have several type_infos
+    std::map<std::string, Handler> byName;
+    uint64_t events = 0;
+    uint64_t cycles = 0;
+    for (const auto & entry : m_handlers) {
+        Handler & row = byName[HandlerName(*entry.first)];
+        row.events += entry.second.events;
+        row.cycles += entry.second.cycles;
+        for (int bucket = 0; bucket < 64; ++bucket) {
+            row.histogram[bucket] += entry.second.histogram[bucket];
+        }
+        events += entry.second.events;
+        cycles += entry.second.cycles;
+    }
+    std::vector<std::pair<std::string, Handler> > rows(byName.begin(), byName.end());
+    std::sort(rows.begin(), rows.end(), [](const std::pair<std::string, Handler> & a, const std::pair<std::string, Handler> & b) {
+        return a.second.cycles > b.second.cycles;
+    });
+
+    double nanosecondsPerCycle = 1.0;
+    uint64_t calibrationCycles = Cycles() - m_startCycles;
+    if (calibrationCycles > 0) {
+        nanosecondsPerCycle = double(SteadyNanoseconds() - m_startNanoseconds) / calibrationCycles;
+    }
+    double loopMilliseconds = (m_lastEnd - m_firstStart) * nanosecondsPerCycle / 1e6;
+
+    std::cout << "Event profile: " << events << " events in " << rows.size() << " handler types, "
+              << std::fixed << std::setprecision(1) << cycles * nanosecondsPerCycle / 1e6 << " ms in handlers of "
+              << loopMilliseconds << " ms in the event loop, " << m_cancelled << " cancelled events skipped\n";
+    std::cout << std::setw(12) << "events" << std::setw(8) << "time %" << std::setw(12) << "total ms"
+              << std::setw(10) << "mean ns" << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns" << "  handler\n";
+    for (size_t i = 0; i < rows.size() && i < m_rows; ++i) {
+        const Handler & row = rows[i].second;
+        std::cout << std::setw(12) << row.events
+                  << std::setprecision(1) << std::setw(8) << (cycles > 0 ? 100.0 * row.cycles / cycles : 0.0)
+                  << std::setprecision(3) << std::setw(12) << row.cycles * nanosecondsPerCycle / 1e6
+                  << std::setprecision(0) << std::setw(10) << (row.events > 0 ? row.cycles * nanosecondsPerCycle / row.events : 0.0)
+                  << std::setw(10) << Quantile(row, 0.5) * nanosecondsPerCycle
+                  << std::setw(10) << Quantile(row, 0.99) * nanosecondsPerCycle
+                  << "  " << rows[i].first << "\n";
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <cstdint>
+#include <typeinfo>
+#include <unordered_map>
+#include "ns3/scheduler.h"
+
+/*
+ * Scheduler that profiles the event loop: it keeps the events in another
+ * scheduler (attribute Scheduler) and, when the simulator removes the
+ * next one to run, wraps it in an event that reads the cycle counter
+ * around the handler. Every event is attributed to its handler type, the
+ * EventImpl class that MakeEvent instantiated for the object or function
+ * and argument types it was scheduled with, and counted in a log2
+ * histogram of cycles. The Rows handler types that took the most time are
+ * printed at Simulator::Destroy.
+ *
+ * Any ns-3 program linked with it can use it: --SchedulerType=ProfilingScheduler.
+ */
+class ProfilingScheduler : public ns3::Scheduler {
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    ProfilingScheduler();
+    virtual ~ProfilingScheduler();
+
+    virtual void Insert(const Event & ev);
+    virtual bool IsEmpty(void) const;
+    virtual Event PeekNext(void) const;
+    virtual Event RemoveNext(void);
+    virtual void Remove(const Event & ev);
+
+    /* counters of one handler type */
+    struct Handler {
+        uint64_t events = 0;
+        uint64_t cycles = 0;
+        uint64_t histogram[64] = {};    // events by floor(log2(cycles))
+    };
+
+protected:
+    virtual void NotifyConstructionCompleted(void);
+    virtual void DoDispose(void);
+
+private:
+    /* print the table, scheduled with Simulator::ScheduleDestroy */
+    void Report(void);
+
+    ns3::TypeId m_schedulerType;
+    uint32_t m_rows;
+    ns3::Ptr<ns3::Scheduler> m_scheduler;
+
+    std::unordered_map<const std::type_info *, Handler> m_handlers;
+    const std::type_info * m_lastType;      // cache of the latest lookup
+    Handler * m_lastHandler;
+    uint64_t m_cancelled;                   // removed cancelled events, not run
+    uint64_t m_firstStart;                  // cycle counter before the first event
+    uint64_t m_lastEnd;                     // and after the latest one
+    uint64_t m_startCycles;                 // calibration of the cycle counter
+    int64_t m_startNanoseconds;
+};
+
+#endif /* EVENT_PROFILER_H */
@@ -0,0 +1,79 @@
+#include <fstream>
+#include "scenario.h"
+#include "ns3/flow-monitor-module.h"
+
+using namespace ns3;
+
+
+/* flow monitor state, one instance per process */
+static struct {
+    FlowMonitorHelper * helper = nullptr;
+    Ptr<FlowMonitor> monitor;
+    Ptr<Ipv4FlowClassifier> classifier;
+    std::ofstream out;
+    double interval = 1.0;          // seconds
+    double last = -1.0;             // time of the latest snapshot, seconds
+} g_flows;
+
+
+/* one row per flow, counters are cumulative since the start of the run */
+static void Snapshot(void) {
+    double now = Simulator::Now().GetSeconds();
+    if (now == g_flows.last) {
+        return;
+    }
+    g_flows.last = now;
+    g_flows.monitor->CheckForLostPackets();
+    for (const auto & entry : g_flows.monitor->GetFlowStats()) {
+        Ipv4FlowClassifier::FiveTuple flow = g_flows.classifier->FindFlow(entry.first);
+        const FlowMonitor::FlowStats & stats = entry.second;
+        double meanDelay = stats.rxPackets > 0 ? stats.delaySum.GetSeconds() / stats.rxPackets : 0.0;
+        double meanJitter = stats.rxPackets > 1 ? stats.jitterSum.GetSeconds() / (stats.rxPackets - 1) : 0.0;
+        g_flows.out << now << "," << entry.first << "," << uint32_t(flow.protocol) << ","
+                    << flow.sourceAddress << "," << flow.sourcePort << ","
+                    << flow.destinationAddress << "," << flow.destinationPort << ","
+                    << stats.txPackets << "," << stats.txBytes << ","
+                    << stats.rxPackets << "," << stats.rxBytes << ","
+                    << stats.lostPackets << "," << meanDelay << "," << meanJitter << "\n";
+    }
+}
+
+
+static void PeriodicSnapshot(void) {
+    Snapshot();
+    Simulator::Schedule(Seconds(g_flows.interval), &PeriodicSnapshot);
+}
+
+
+void InstallFlowMonitor(const ScenarioConfig & config, Topology & topology) {
+    std::string path = OutputPrefix(config) + "_flows.csv";
+    g_flows.out.open(path.c_str());
+    if (!g_flows.out) {
+        NS_FATAL_ERROR("Cannot open flow monitor file " << path);
+    }
+    g_flows.out << "seconds,flow,protocol,source,sourcePort,destination,destinationPort,"
+                << "txPackets,txBytes,rxPackets,rxBytes,lostPackets,meanDelaySeconds,meanJitterSeconds\n";
+
+    // end to end metrics only need the probes of the endpoints
+    NodeContainer endpoints;
+    endpoints.Add(topology.activeSenderNodes);
+    endpoints.Add(topology.receiverNode);
+    g_flows.helper = new FlowMonitorHelper;
+    g_flows.monitor = g_flows.helper->Install(endpoints);
+    g_flows.classifier = DynamicCast<Ipv4FlowClassifier>(g_flows.helper->GetClassifier());
+    g_flows.interval = config.flowInterval;
+    Simulator::Schedule(Seconds(g_flows.interval), &PeriodicSnapshot);
+}
+
+
+void CloseFlowMonitor(void) {
+    if (!g_flows.helper) {
+        return;
+    }
+    Snapshot();     // end of run, unless the last periodic snapshot fell on the stop time
+    g_flows.out.close();
+    g_flows.classifier = 0;
+    g_flows.monitor = 0;
+    delete g_flows.helper;
+    g_flows.helper = nullptr;
+}
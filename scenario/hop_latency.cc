@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "scenario.h"
+#include "latency_histogram.h"
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+using namespace ns3;
+
+
+/* ingress time, time and stage of the last point a packet passed */
+class HopTag : public Tag {
+public:
+    static TypeId GetTypeId(void) {
+        static TypeId tid = TypeId("HopTag")
+            .SetParent<Tag>()
+            .AddConstructor<HopTag>();
+        return tid;
+    }
+
+    virtual TypeId GetInstanceTypeId(void) const {
+        return GetTypeId();
+    }
+
+    virtual uint32_t GetSerializedSize(void) const {
+        return 17;
+    }
+
+    virtual void Serialize(TagBuffer buffer) const {
+        buffer.WriteU64(uint64_t(ingress));
+        buffer.WriteU64(uint64_t(last));
+        buffer.WriteU8(stage);
+    }
+
+    virtual void Deserialize(TagBuffer buffer) {
+        ingress = int64_t(buffer.ReadU64());
+        last = int64_t(buffer.ReadU64());
+        stage = buffer.ReadU8();
+    }
+
+    virtual void Print(std::ostream & os) const {
+        os << "ingress=" << ingress << "ns last=" << last << "ns stage=" << uint32_t(stage);
+    }
+
+    int64_t ingress = 0;
+    int64_t last = 0;
+    uint8_t stage = 0;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(HopTag);
+
+
+/* a point of the sender to receiver path, and the segment ending there */
+struct HopStage {
+    std::string name;
+    std::string segment;
+    LatencyHistogram delay;         // from the previous stage
+    uint64_t sumNanoseconds = 0;
+};
+
+
+/* stages in path order, stage 0 is the ingress, one instance per process */
+static struct {
+    Ipv4Address receiver;
+    std::vector<HopStage> stages;
+    LatencyHistogram total;         // ingress to the last stage
+    uint64_t totalNanoseconds = 0;
+} g_hops;
+
+
+static void Record(LatencyHistogram & histogram, uint64_t & sum, int64_t nanoseconds) {
+    histogram.Record(nanoseconds);
+    sum += uint64_t(std::max<int64_t>(nanoseconds, 0));
+}
+
+
+/* ingress: a packet of the sender node's ip layer to the receiver */
+static void HopIngress(const Ipv4Header & header, Ptr<const Packet> p, uint32_t interface) {
+    HopTag tag;
+    if (header.GetDestination() != g_hops.receiver || p->PeekPacketTag(tag)) {
+        return;
+    }
+    tag.ingress = Simulator::Now().GetNanoSeconds();
+    tag.last = tag.ingress;
+    p->AddPacketTag(tag);
+}
+
+
+/*
+ * The tag is moved on in the packet object that travels on: the device
+ * PhyTxBegin and the ip Rx packets are, the device MacRx ones are copies.
+ * A stage seen again (a csma PhyTxBegin retried after a backoff) leaves the
+ * tag alone, so the time since the first attempt goes to the next segment.
+ */
+static void HopPass(uint8_t stage, Ptr<const Packet> p) {
+    HopTag tag;
+    if (!p->PeekPacketTag(tag) || tag.stage == stage) {
+        return;
+    }
+    int64_t now = Simulator::Now().GetNanoSeconds();
+    if (tag.stage + 1 == stage) {
+        HopStage & hop = g_hops.stages[stage];
+        Record(hop.delay, hop.sumNanoseconds, now - tag.last);
+    }
+    if (stage + 1u == g_hops.stages.size()) {
+        Record(g_hops.total, g_hops.totalNanoseconds, now - tag.ingress);
+        return;
+    }
+    tag.last = now;
+    tag.stage = stage;
+    ConstCast<Packet>(p)->ReplacePacketTag(tag);
+}
+
+
+static void HopIpRx(uint8_t stage, Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface) {
+    HopPass(stage, p);
+}
+
+
+static void AddStage(const std::string & name, const std::string & segment) {
+    g_hops.stages.push_back(HopStage());
+    g_hops.stages.back().name = name;
+    g_hops.stages.back().segment = segment;
+}
+
+
+static void ConnectIpRx(Ptr<Node> node) {
+    if (IsLocal(node)) {
+        node->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext("Rx", MakeBoundCallback(&HopIpRx, uint8_t(g_hops.stages.size() - 1)));
+    }
+}
+
+
+static void ConnectPhyTxBegin(Ptr<NetDevice> device) {
+    if (IsLocal(device->GetNode())) {
+        device->TraceConnectWithoutContext("PhyTxBegin", MakeBoundCallback(&HopPass, uint8_t(g_hops.stages.size() - 1)));
+    }
+}
+
+
+/*
+ * Forward direction only (data, echo requests). Wifi stations have no
+ * PhyTxBegin that sees the queued packet, so their segment is queue,
+ * contention and air time together.
+ */
+void InstallHopLatency(const ScenarioConfig & config, Topology & topology) {
+    g_hops.receiver = topology.receiverAddress;
+    AddStage("sender ip", "");
+    for (uint32_t i = 0; i < topology.activeSenderNodes.GetN(); ++i) {
+        Ptr<Node> node = topology.activeSenderNodes.Get(i);
+        if (IsLocal(node)) {
+            node->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext("SendOutgoing", MakeCallback(&HopIngress));
+        }
+    }
+    if (config.sender == "csma") {
+        AddStage("sender csma tx", "sender queue");
+        for (uint32_t i = 0; i < topology.activeSenderNodes.GetN(); ++i) {
+            for (uint32_t j = 0; j < topology.senderDevices.GetN(); ++j) {
+                if (topology.senderDevices.Get(j)->GetNode() == topology.activeSenderNodes.Get(i)) {
+                    ConnectPhyTxBegin(topology.senderDevices.Get(j));
+                }
+            }
+        }
+        AddStage("n0 rx", "sender lan");
+        ConnectIpRx(topology.p2pNodes.Get(0));
+    }
+    else if (config.sender == "wifi") {
+        AddStage("n0 rx", "sender wifi");
+        ConnectIpRx(topology.p2pNodes.Get(0));
+    }
+    AddStage("n0 p2p tx", "n0 queue");
+    ConnectPhyTxBegin(topology.p2pDevices.Get(0));
+    AddStage("n1 rx", "p2p link");
+    ConnectIpRx(topology.p2pNodes.Get(1));
+    if (config.receiver == "csma") {
+        AddStage("n1 csma tx", "n1 queue");
+        ConnectPhyTxBegin(topology.receiverDevices.Get(0));
+        AddStage("receiver rx", "receiver lan");
+        ConnectIpRx(topology.receiverNode);
+    }
+}
+
+
+/* --distributed: the segments up to n0 are on the sender rank, the others on the receiver rank */
+void ReduceHopLatency(const ScenarioConfig & config) {
+#ifdef NS3_MPI
+    if (!config.distributed) {
+        return;
+    }
+    std::vector<std::pair<LatencyHistogram *, uint64_t *> > histograms;
+    for (HopStage & hop : g_hops.stages) {
+        histograms.push_back(std::make_pair(&hop.delay, &hop.sumNanoseconds));
+    }
+    histograms.push_back(std::make_pair(&g_hops.total, &g_hops.totalNanoseconds));
+    for (const auto & histogram : histograms) {
+        uint64_t count = histogram.first->GetCount();
+        int64_t max = histogram.first->GetMax();
+        MPI_Allreduce(MPI_IN_PLACE, histogram.first->Counts(), LatencyHistogram::BUCKETS, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, &count, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, &max, 1, MPI_INT64_T, MPI_MAX, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, histogram.second, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+        histogram.first->SetTotals(count, max);
+    }
+#endif
+}
+
+
+static const double QUANTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+
+
+/* one row per segment in path order, then the total; without losses the means add up to the total's */
+struct HopRow {
+    std::string segment;
+    std::string from;
+    std::string to;
+    const LatencyHistogram * delay;
+    uint64_t sumNanoseconds;
+};
+
+
+static std::vector<HopRow> Rows(void) {
+    std::vector<HopRow> rows;
+    for (size_t i = 1; i < g_hops.stages.size(); ++i) {
+        const HopStage & hop = g_hops.stages[i];
+        rows.push_back({ hop.segment, g_hops.stages[i - 1].name, hop.name, &hop.delay, hop.sumNanoseconds });
+    }
+    rows.push_back({ "total", g_hops.stages.front().name, g_hops.stages.back().name, &g_hops.total, g_hops.totalNanoseconds });
+    return rows;
+}
+
+
+static double Mean(const HopRow & row) {
+    return row.delay->GetCount() > 0 ? double(row.sumNanoseconds) / row.delay->GetCount() : 0.0;
+}
+
+
+void WriteHopLatency(const std::string & path) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        NS_FATAL_ERROR("Cannot open hop latency file " << path);
+    }
+    out << "segment,from,to,packets,meanSeconds,p50Seconds,p90Seconds,p99Seconds,p999Seconds,maxSeconds\n";
+    for (const HopRow & row : Rows()) {
+        out << row.segment << "," << row.from << "," << row.to << "," << row.delay->GetCount() << "," << Mean(row) * 1e-9;
+        for (double q : QUANTILES) {
+            out << "," << row.delay->Quantile(q) * 1e-9;
+        }
+        out << "," << row.delay->GetMax() * 1e-9 << "\n";
+    }
+}
+
+
+/* --verbose=stats: one line per segment, milliseconds */
+void PrintHopLatency(void) {
+    std::cout << std::left << std::setw(14) << "segment" << std::setw(32) << "points"
+              << std::right << std::setw(10) << "packets" << std::setw(10) << "mean ms" << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "p99.9 ms" << std::setw(10) << "max ms" << "\n";
+    for (const HopRow & row : Rows()) {
+        std::cout << std::left << std::setw(14) << row.segment << std::setw(32) << row.from + " -> " + row.to
+                  << std::right << std::setw(10) << row.delay->GetCount() << std::fixed << std::setprecision(3)
+                  << std::setw(10) << Mean(row) * 1e-6;
+        for (double q : QUANTILES) {
+            std::cout << std::setw(10) << row.delay->Quantile(q) * 1e-6;
+        }
+        std::cout << std::setw(10) << row.delay->GetMax() * 1e-6 << "\n" << std::defaultfloat;
+    }
+}
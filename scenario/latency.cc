@@ -0,0 +1,180 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "scenario.h"
+#include "latency_histogram.h"
+#include "ns3/applications-module.h"
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+using namespace ns3;
+
+
+/* send time and flow of an echo request, added by the client's Tx trace */
+class EchoTimestampTag : public Tag {
+public:
+    static TypeId GetTypeId(void) {
+        static TypeId tid = TypeId("EchoTimestampTag")
+            .SetParent<Tag>()
+            .AddConstructor<EchoTimestampTag>();
+        return tid;
+    }
+
+    virtual TypeId GetInstanceTypeId(void) const {
+        return GetTypeId();
+    }
+
+    virtual uint32_t GetSerializedSize(void) const {
+        return 12;
+    }
+
+    virtual void Serialize(TagBuffer buffer) const {
+        buffer.WriteU64(uint64_t(nanoseconds));
+        buffer.WriteU32(flow);
+    }
+
+    virtual void Deserialize(TagBuffer buffer) {
+        nanoseconds = int64_t(buffer.ReadU64());
+        flow = buffer.ReadU32();
+    }
+
+    virtual void Print(std::ostream & os) const {
+        os << "sent=" << nanoseconds << "ns flow=" << flow;
+    }
+
+    int64_t nanoseconds = 0;
+    uint32_t flow = 0;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(EchoTimestampTag);
+
+
+/* the echo server drops every tag, the client keeps the send times of the
+   latest requests by packet uid, a late reply finds its slot taken */
+static const size_t SENT_SLOTS = 1024;
+
+struct LatencyFlow {
+    Ipv4Address source;
+    LatencyHistogram rtt;
+    LatencyHistogram oneWay;        // client to server
+    std::vector<std::pair<uint64_t, int64_t> > sent;     // uid, send time ns
+};
+
+
+/* per flow histograms, one instance per process */
+static struct {
+    std::vector<LatencyFlow> flows;
+} g_latency;
+
+
+static void ClientTx(uint32_t flow, Ptr<const Packet> p) {
+    EchoTimestampTag tag;
+    tag.nanoseconds = Simulator::Now().GetNanoSeconds();
+    tag.flow = flow;
+    p->AddPacketTag(tag);
+    g_latency.flows[flow].sent[p->GetUid() % SENT_SLOTS] = std::make_pair(p->GetUid(), tag.nanoseconds);
+}
+
+
+static void ClientRx(uint32_t flow, Ptr<const Packet> p) {
+    const std::pair<uint64_t, int64_t> & sent = g_latency.flows[flow].sent[p->GetUid() % SENT_SLOTS];
+    if (sent.first == p->GetUid()) {
+        g_latency.flows[flow].rtt.Record(Simulator::Now().GetNanoSeconds() - sent.second);
+    }
+}
+
+
+static void ServerRx(Ptr<const Packet> p) {
+    EchoTimestampTag tag;
+    if (p->PeekPacketTag(tag) && tag.flow < g_latency.flows.size()) {
+        g_latency.flows[tag.flow].oneWay.Record(Simulator::Now().GetNanoSeconds() - tag.nanoseconds);
+    }
+}
+
+
+/* flows are the active sender nodes, known on every rank; the clients are
+   on the sender rank and the server on the receiver rank */
+void InstallLatency(const ScenarioConfig & config, Topology & topology) {
+    g_latency.flows.resize(topology.activeSenderNodes.GetN());
+    for (uint32_t i = 0; i < topology.activeSenderNodes.GetN(); ++i) {
+        LatencyFlow & flow = g_latency.flows[i];
+        flow.source = topology.activeSenderNodes.Get(i)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+        flow.sent.assign(SENT_SLOTS, std::make_pair(~uint64_t(0), int64_t(0)));
+    }
+    // every active sender is local to the sender rank, in activeSenderNodes order
+    for (uint32_t i = 0; i < topology.senderApps.GetN(); ++i) {
+        topology.senderApps.Get(i)->TraceConnectWithoutContext("Tx", MakeBoundCallback(&ClientTx, i));
+        topology.senderApps.Get(i)->TraceConnectWithoutContext("Rx", MakeBoundCallback(&ClientRx, i));
+    }
+    if (topology.receiverApps.GetN() > 0) {
+        topology.receiverApps.Get(0)->TraceConnectWithoutContext("Rx", MakeCallback(&ServerRx));
+    }
+}
+
+
+/* --distributed: the RTTs are on the sender rank, the one-way delays on the receiver rank */
+void ReduceLatency(const ScenarioConfig & config) {
+#ifdef NS3_MPI
+    if (!config.distributed) {
+        return;
+    }
+    for (LatencyFlow & flow : g_latency.flows) {
+        for (LatencyHistogram * histogram : { &flow.rtt, &flow.oneWay }) {
+            uint64_t count = histogram->GetCount();
+            int64_t max = histogram->GetMax();
+            MPI_Allreduce(MPI_IN_PLACE, histogram->Counts(), LatencyHistogram::BUCKETS, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+            MPI_Allreduce(MPI_IN_PLACE, &count, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+            MPI_Allreduce(MPI_IN_PLACE, &max, 1, MPI_INT64_T, MPI_MAX, MPI_COMM_WORLD);
+            histogram->SetTotals(count, max);
+        }
+    }
+#endif
+}
+
+
+static const double QUANTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+
+
+void WriteLatency(const std::string & path) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        NS_FATAL_ERROR("Cannot open latency file " << path);
+    }
+    out << "flow,source,metric,packets,p50Seconds,p90Seconds,p99Seconds,p999Seconds,maxSeconds\n";
+    for (size_t i = 0; i < g_latency.flows.size(); ++i) {
+        const LatencyFlow & flow = g_latency.flows[i];
+        const std::pair<const char *, const LatencyHistogram *> metrics[] = { { "rtt", &flow.rtt }, { "oneWay", &flow.oneWay } };
+        for (const auto & metric : metrics) {
+            out << i << "," << flow.source << "," << metric.first << "," << metric.second->GetCount();
+            for (double q : QUANTILES) {
+                out << "," << metric.second->Quantile(q) * 1e-9;
+            }
+            out << "," << metric.second->GetMax() * 1e-9 << "\n";
+        }
+    }
+}
+
+
+/* --verbose=stats: one line per flow and metric, milliseconds */
+void PrintLatency(void) {
+    std::cout << std::left << std::setw(6) << "flow" << std::setw(16) << "source" << std::setw(8) << "metric"
+              << std::right << std::setw(10) << "packets" << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms"
+              << std::setw(10) << "p99 ms" << std::setw(10) << "p99.9 ms" << std::setw(10) << "max ms" << "\n";
+    for (size_t i = 0; i < g_latency.flows.size(); ++i) {
+        const LatencyFlow & flow = g_latency.flows[i];
+        std::ostringstream source;
+        source << flow.source;
+        const std::pair<const char *, const LatencyHistogram *> metrics[] = { { "rtt", &flow.rtt }, { "oneWay", &flow.oneWay } };
+        for (const auto & metric : metrics) {
+            std::cout << std::left << std::setw(6) << i << std::setw(16) << source.str() << std::setw(8) << metric.first
+                      << std::right << std::setw(10) << metric.second->GetCount() << std::fixed << std::setprecision(3);
+            for (double q : QUANTILES) {
+                std::cout << std::setw(10) << metric.second->Quantile(q) * 1e-6;
+            }
+            std::cout << std::setw(10) << metric.second->GetMax() * 1e-6 << "\n" << std::defaultfloat;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cmath>
+#include "latency_histogram.h"
+
+
+LatencyHistogram::LatencyHistogram()
+    : m_counts(),
+      m_count(0),
+      m_max(0) {
+}
+
+
+/*
+ * Values below 2^(SUB_BITS + 1) have a bucket each. Above, a value with
+ * its highest bit at SUB_BITS + shift keeps its top SUB_BITS + 1 bits:
+ * shift << SUB_BITS + (value >> shift) continues the index from there.
+ */
+size_t LatencyHistogram::Index(uint64_t value) {
+    value = std::min(value, (uint64_t(1) << MAX_BITS) - 1);
+    int msb = 63 - __builtin_clzll(value | ((uint64_t(1) << (SUB_BITS + 1)) - 1));
+    int shift = msb - SUB_BITS;
+    return (size_t(shift) << SUB_BITS) + size_t(value >> shift);
+}
+
+
+uint64_t LatencyHistogram::HighestValue(size_t index) {
+    if (index < (size_t(2) << SUB_BITS)) {
+        return index;
+    }
+    int shift = int(index >> SUB_BITS) - 1;
+    uint64_t sub = index - (size_t(shift) << SUB_BITS);
+    return ((sub + 1) << shift) - 1;
+}
+
+
+void LatencyHistogram::Record(int64_t nanoseconds) {
+    uint64_t value = nanoseconds > 0 ? uint64_t(nanoseconds) : 0;
+    m_counts[Index(value)]++;
+    m_count++;
+    m_max = std::max(m_max, int64_t(value));
+}
+
+
+uint64_t LatencyHistogram::GetCount(void) const {
+    return m_count;
+}
+
+
+int64_t LatencyHistogram::GetMax(void) const {
+    return m_max;
+}
+
+
+int64_t LatencyHistogram::Quantile(double q) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(q * m_count)));
+    uint64_t seen = 0;
+    for (size_t index = 0; index < BUCKETS; ++index) {
+        seen += m_counts[index];
+        if (seen >= rank) {
+            return std::min(int64_t(HighestValue(index)), m_max);
+        }
+    }
+    return m_max;
+}
+
+
+uint64_t * LatencyHistogram::Counts(void) {
+    return m_counts;
+}
+
+
+void LatencyHistogram::SetTotals(uint64_t count, int64_t max) {
+    m_count = count;
+    m_max = max;
+}
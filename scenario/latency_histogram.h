@@ -0,0 +1,45 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Log-linear (HDR style) histogram of nanosecond latencies in fixed memory.
+ *
+ * Every power of two is split into 64 linear sub-buckets, so a recorded
+ * value is known to within 1/64 (1.6%) of itself, from 1 ns up to 2^40 ns
+ * (about 18 minutes, larger values count as that). Recording is a shift and
+ * an increment; the 2240 counters are the whole state, so histograms of
+ * different runs or MPI ranks add up bucket by bucket.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 6;
+    static const int MAX_BITS = 40;
+    static const size_t BUCKETS = size_t(MAX_BITS - SUB_BITS + 1) << SUB_BITS;
+
+    LatencyHistogram();
+
+    /* negative values count as 0 */
+    void Record(int64_t nanoseconds);
+
+    uint64_t GetCount(void) const;
+    int64_t GetMax(void) const;
+    /* highest value of the bucket holding the q quantile, 0 if empty */
+    int64_t Quantile(double q) const;
+
+    /* for MPI_Allreduce */
+    uint64_t * Counts(void);
+    void SetTotals(uint64_t count, int64_t max);
+
+private:
+    static size_t Index(uint64_t value);
+    static uint64_t HighestValue(size_t index);
+
+    uint64_t m_counts[BUCKETS];
+    uint64_t m_count;
+    int64_t m_max;
+};
+
+#endif /* LATENCY_HISTOGRAM_H */
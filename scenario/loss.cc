@@ -0,0 +1,90 @@
+#include <iostream>
+#include "scenario.h"
+#include "skip_error_model.h"
+#include "replay_error_model.h"
+#include "drop_stats.h"
+
+using namespace ns3;
+
+
+/* --lossModel=replay: the models of every site, for the report at the end of the run */
+static struct {
+    Ptr<DropSchedule> schedules[2];     // by DropSite
+    std::vector<Ptr<ReplayErrorModel>> models[2];
+} g_replay;
+
+
+/* RateErrorModel drawing from Uniform[ranVarMin, ranVarMax] */
+static Ptr<RateErrorModel> CreateRateErrorModel(const std::string & ranVarMin, const std::string & ranVarMax, double errorRate) {
+    std::string ranVar = "ns3::UniformRandomVariable[Min=" + ranVarMin + "|Max=" + ranVarMax + "]";
+    return CreateObjectWithAttributes<RateErrorModel>("RanVar", StringValue(ranVar), "ErrorRate", DoubleValue(errorRate));
+}
+
+
+/* a recorded drop site replayed on device */
+static Ptr<ErrorModel> CreateReplayErrorModel(const ScenarioConfig & config, DropSite site, Ptr<NetDevice> device) {
+    if (!g_replay.schedules[site]) {
+        g_replay.schedules[site] = Create<DropSchedule>(config.lossSchedule, uint8_t(site));
+    }
+    Ptr<ReplayErrorModel> em = CreateObjectWithAttributes<ReplayErrorModel>(
+        "Match", EnumValue(config.replayMatch == "seq" ? ReplayErrorModel::MATCH_SEQ : ReplayErrorModel::MATCH_TIME),
+        "Window", TimeValue(Seconds(config.replayWindow)),
+        "Ethernet", BooleanValue(DynamicCast<CsmaNetDevice>(device) != 0));
+    em->SetSchedule(g_replay.schedules[site]);
+    g_replay.models[site].push_back(em);
+    return em;
+}
+
+
+/* --lossModel: rate, or the skip-ahead bernoulli and gilbert models with the same loss rates */
+static Ptr<ErrorModel> CreateErrorModel(const ScenarioConfig & config, const std::string & ranVarMin, const std::string & ranVarMax, double errorRate) {
+    if (config.lossModel == "rate") {
+        return CreateRateErrorModel(ranVarMin, ranVarMax, errorRate);
+    }
+    Ptr<SkipErrorModel> em;
+    if (config.lossModel == "bernoulli") {
+        em = CreateObject<SkipBernoulliErrorModel>();
+    }
+    else {
+        em = CreateObjectWithAttributes<SkipGilbertElliottErrorModel>("BurstLength", DoubleValue(config.lossBurst));
+    }
+    em->SetAttribute("RanVarMin", DoubleValue(std::stod(ranVarMin)));
+    em->SetAttribute("RanVarMax", DoubleValue(std::stod(ranVarMax)));
+    em->SetAttribute("ErrorRate", DoubleValue(errorRate));
+    return em;
+}
+
+
+void InstallLoss(const ScenarioConfig & config, Topology & topology) {
+    bool replay = config.lossModel == "replay";
+
+    // receiver
+    Ptr<ErrorModel> receiverEm = replay ? CreateReplayErrorModel(config, RECEIVER_DROP, topology.receiverDevice)
+                                        : CreateErrorModel(config, config.receiverRanVarMin, config.receiverRanVarMax, config.receiverErrorRate);
+    topology.receiverDevice->SetAttribute("ReceiveErrorModel", PointerValue(receiverEm));
+
+    // inter
+    for (uint32_t i = 0; i < topology.interDevices.GetN(); ++i) {
+        Ptr<NetDevice> device = topology.interDevices.Get(i);
+        Ptr<ErrorModel> interEm = replay ? CreateReplayErrorModel(config, INTER_DROP, device)
+                                         : CreateErrorModel(config, config.interRanVarMin, config.interRanVarMax, config.interErrorRate);
+        device->SetAttribute("ReceiveErrorModel", PointerValue(interEm));
+    }
+}
+
+
+void CloseLoss(void) {
+    for (DropSite site : { RECEIVER_DROP, INTER_DROP }) {
+        if (!g_replay.schedules[site]) {
+            continue;
+        }
+        uint64_t matched = 0;
+        for (Ptr<ReplayErrorModel> em : g_replay.models[site]) {
+            matched += em->GetMatched();
+        }
+        std::cout << "replayed " << matched << " of " << g_replay.schedules[site]->records.size()
+                  << " scheduled " << DropSiteName(site) << " drops\n";
+        g_replay.models[site].clear();
+        g_replay.schedules[site] = 0;
+    }
+}
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cmath>
+#include "range_wifi_channel.h"
+#include "ns3/assert.h"
+#include "ns3/double.h"
+#include "ns3/mobility-model.h"
+#include "ns3/pointer.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-ppdu.h"
+#include "ns3/wifi-utils.h"
+
+using namespace ns3;
+
+NS_OBJECT_ENSURE_REGISTERED(RangeYansWifiChannel);
+NS_OBJECT_ENSURE_REGISTERED(RangeYansWifiPhy);
+
+
+/* at most this many cells per side, whatever the range */
+static const double MAX_GRID_SIDE = 1024;
+
+
+TypeId RangeYansWifiChannel::GetTypeId(void) {
+    static TypeId tid = TypeId("RangeYansWifiChannel")
+        .SetParent<YansWifiChannel>()
+        .AddConstructor<RangeYansWifiChannel>()
+        .AddAttribute("Range", "Meters beyond which a transmission is not delivered",
+                      DoubleValue(250.0),
+                      MakeDoubleAccessor(&RangeYansWifiChannel::m_range),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("MaxSpeed", "Meters per second no PHY of the channel moves faster than",
+                      DoubleValue(4.0),
+                      MakeDoubleAccessor(&RangeYansWifiChannel::m_maxSpeed),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("PositionTick", "Time between two position jumps of the mobility models, 0 for continuous movement",
+                      TimeValue(Seconds(0.0)),
+                      MakeTimeAccessor(&RangeYansWifiChannel::m_positionTick),
+                      MakeTimeChecker())
+        .AddAttribute("RebuildInterval", "Age of the grid at which it is built again from the mobility models",
+                      TimeValue(Seconds(1.0)),
+                      MakeTimeAccessor(&RangeYansWifiChannel::m_rebuildInterval),
+                      MakeTimeChecker());
+    return tid;
+}
+
+
+RangeYansWifiChannel::RangeYansWifiChannel()
+    : m_range(250.0),
+      m_maxSpeed(4.0),
+      m_positionTick(Seconds(0.0)),
+      m_rebuildInterval(Seconds(1.0)),
+      m_minX(0.0),
+      m_minY(0.0),
+      m_cell(1.0),
+      m_columns(0),
+      m_rows(0) {
+}
+
+
+RangeYansWifiChannel::~RangeYansWifiChannel() {
+}
+
+
+/* the PHYs in channel order, bucketed by their current position */
+void RangeYansWifiChannel::Rebuild(void) {
+    if (!m_loss) {
+        PointerValue loss;
+        PointerValue delay;
+        GetAttribute("PropagationLossModel", loss);
+        GetAttribute("PropagationDelayModel", delay);
+        m_loss = loss.Get<PropagationLossModel>();
+        m_delay = delay.Get<PropagationDelayModel>();
+    }
+
+    m_phys.clear();
+    std::vector<Vector> positions;
+    for (std::size_t i = 0; i < GetNDevices(); ++i) {
+        Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(GetDevice(i));
+        NS_ASSERT(device);
+        Ptr<YansWifiPhy> phy = DynamicCast<YansWifiPhy>(device->GetPhy());
+        m_phys.push_back(phy);
+        positions.push_back(phy->GetMobility()->GetPosition());
+    }
+    m_builtAt = Simulator::Now();
+
+    double maxX = 0.0;
+    double maxY = 0.0;
+    m_minX = 0.0;
+    m_minY = 0.0;
+    if (!positions.empty()) {
+        m_minX = maxX = positions[0].x;
+        m_minY = maxY = positions[0].y;
+    }
+    for (const Vector & position : positions) {
+        m_minX = std::min(m_minX, position.x);
+        m_minY = std::min(m_minY, position.y);
+        maxX = std::max(maxX, position.x);
+        maxY = std::max(maxY, position.y);
+    }
+    m_cell = std::max(std::max(m_range, 1.0), std::max(maxX - m_minX, maxY - m_minY) / MAX_GRID_SIDE);
+    m_columns = uint32_t((maxX - m_minX) / m_cell) + 1;
+    m_rows = uint32_t((maxY - m_minY) / m_cell) + 1;
+
+    // counting sort of the PHY indexes by cell, stable so every cell stays in channel order
+    std::vector<uint32_t> cellOf(positions.size());
+    m_cellStart.assign(size_t(m_columns) * m_rows + 1, 0);
+    for (uint32_t i = 0; i < positions.size(); ++i) {
+        uint32_t column = std::min(m_columns - 1, uint32_t((positions[i].x - m_minX) / m_cell));
+        uint32_t row = std::min(m_rows - 1, uint32_t((positions[i].y - m_minY) / m_cell));
+        cellOf[i] = row * m_columns + column;
+        m_cellStart[cellOf[i] + 1]++;
+    }
+    for (size_t c = 1; c < m_cellStart.size(); ++c) {
+        m_cellStart[c] += m_cellStart[c - 1];
+    }
+    m_cellPhys.resize(positions.size());
+    std::vector<uint32_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (uint32_t i = 0; i < positions.size(); ++i) {
+        m_cellPhys[fill[cellOf[i]]++] = i;
+    }
+}
+
+
+/* YansWifiChannel::Send() restricted to the PHYs within m_range */
+void RangeYansWifiChannel::SendInRange(Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) {
+    if (m_phys.size() != GetNDevices() || Simulator::Now() - m_builtAt >= m_rebuildInterval) {
+        Rebuild();
+    }
+    Ptr<MobilityModel> senderMobility = sender->GetMobility();
+    NS_ASSERT(senderMobility != 0);
+
+    // cells that can hold a PHY within range now, given how far it may have moved since the build;
+    // a PHY that moves in ticks may have jumped a whole tick's distance right after it
+    Vector position = senderMobility->GetPosition();
+    double radius = m_range + m_maxSpeed * ((Simulator::Now() - m_builtAt) + m_positionTick).GetSeconds();
+    double firstColumn = std::floor((position.x - radius - m_minX) / m_cell);
+    double lastColumn = std::floor((position.x + radius - m_minX) / m_cell);
+    double firstRow = std::floor((position.y - radius - m_minY) / m_cell);
+    double lastRow = std::floor((position.y + radius - m_minY) / m_cell);
+    m_candidates.clear();
+    if (lastColumn >= 0 && firstColumn < m_columns && lastRow >= 0 && firstRow < m_rows) {
+        uint32_t column0 = uint32_t(std::max(0.0, firstColumn));
+        uint32_t column1 = uint32_t(std::min(double(m_columns - 1), lastColumn));
+        uint32_t row0 = uint32_t(std::max(0.0, firstRow));
+        uint32_t row1 = uint32_t(std::min(double(m_rows - 1), lastRow));
+        for (uint32_t row = row0; row <= row1; ++row) {
+            uint32_t first = m_cellStart[row * m_columns + column0];
+            uint32_t last = m_cellStart[row * m_columns + column1 + 1];
+            m_candidates.insert(m_candidates.end(), m_cellPhys.begin() + first, m_cellPhys.begin() + last);
+        }
+    }
+    // channel order, as the receptions of the full channel are scheduled
+    std::sort(m_candidates.begin(), m_candidates.end());
+
+    for (uint32_t index : m_candidates) {
+        Ptr<YansWifiPhy> receiver = m_phys[index];
+        if (receiver == sender || receiver->GetChannelNumber() != sender->GetChannelNumber()) {
+            continue;
+        }
+        Ptr<MobilityModel> receiverMobility = receiver->GetMobility();
+        if (senderMobility->GetDistanceFrom(receiverMobility) > m_range) {
+            continue;
+        }
+        Time delay = m_delay->GetDelay(senderMobility, receiverMobility);
+        double rxPowerDbm = m_loss->CalcRxPower(txPowerDbm, senderMobility, receiverMobility);
+        Ptr<WifiPpdu> copy = Copy(ppdu);
+        Ptr<NetDevice> dstNetDevice = receiver->GetDevice();
+        uint32_t dstNode = dstNetDevice ? dstNetDevice->GetNode()->GetId() : 0xffffffff;
+        Simulator::ScheduleWithContext(dstNode, delay, &RangeYansWifiChannel::Receive, receiver, copy, rxPowerDbm);
+    }
+}
+
+
+/* as YansWifiChannel::Receive() */
+void RangeYansWifiChannel::Receive(Ptr<YansWifiPhy> receiver, Ptr<WifiPpdu> ppdu, double rxPowerDbm) {
+    if ((rxPowerDbm + receiver->GetRxGain()) < receiver->GetRxSensitivity()) {
+        return;
+    }
+    receiver->StartReceivePreamble(ppdu, DbmToW(rxPowerDbm + receiver->GetRxGain()));
+}
+
+
+TypeId RangeYansWifiPhy::GetTypeId(void) {
+    static TypeId tid = TypeId("RangeYansWifiPhy")
+        .SetParent<YansWifiPhy>()
+        .AddConstructor<RangeYansWifiPhy>();
+    return tid;
+}
+
+
+RangeYansWifiPhy::RangeYansWifiPhy() {
+}
+
+
+RangeYansWifiPhy::~RangeYansWifiPhy() {
+}
+
+
+/* as YansWifiPhy::StartTx(), through the range channel when there is one */
+void RangeYansWifiPhy::StartTx(Ptr<WifiPpdu> ppdu) {
+    Ptr<RangeYansWifiChannel> channel = DynamicCast<RangeYansWifiChannel>(GetChannel());
+    if (!channel) {
+        YansWifiPhy::StartTx(ppdu);
+        return;
+    }
+    WifiTxVector txVector = ppdu->GetTxVector();
+    channel->SendInRange(this, ppdu, GetTxPowerForTransmission(txVector) + GetTxGain());
+}
+
+
+RangeYansWifiPhyHelper::RangeYansWifiPhyHelper() {
+    SetErrorRateModel("ns3::NistErrorRateModel");
+    m_phy.SetTypeId(RangeYansWifiPhy::GetTypeId());
+}
@@ -0,0 +1,84 @@
+#ifndef RANGE_WIFI_CHANNEL_H
+#define RANGE_WIFI_CHANNEL_H
+
+#include <cstdint>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/yans-wifi-helper.h"
+
+/*
+ * Yans channel that only delivers a transmission to the PHYs within Range
+ * meters of the sender.
+ *
+ * YansWifiChannel::Send() schedules a reception on every other PHY of the
+ * channel, so a transmission costs one event per station even when the
+ * receiver drops it right away as too weak. This channel keeps the PHYs in
+ * a uniform grid of Range sized cells, rebuilt from the mobility models
+ * every RebuildInterval; a search radius grown by MaxSpeed times the age of
+ * the grid covers the stations that moved since. Mobility models that jump
+ * once per PositionTick rather than move continuously add a tick to that age. Receivers within Range get
+ * the same delay, power and event order as from the full channel, so with a
+ * Range beyond the distance at which the loss model falls below the
+ * receivers' RxSensitivity the results do not change at all.
+ *
+ * YansWifiChannel::Send() is not virtual: the PHYs must be RangeYansWifiPhy,
+ * created by RangeYansWifiPhyHelper, which hand their transmissions to this
+ * channel.
+ */
+class RangeYansWifiChannel : public ns3::YansWifiChannel {
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    RangeYansWifiChannel();
+    virtual ~RangeYansWifiChannel();
+
+    void SendInRange(ns3::Ptr<ns3::YansWifiPhy> sender, ns3::Ptr<const ns3::WifiPpdu> ppdu, double txPowerDbm);
+
+private:
+    static void Receive(ns3::Ptr<ns3::YansWifiPhy> receiver, ns3::Ptr<ns3::WifiPpdu> ppdu, double rxPowerDbm);
+
+    void Rebuild(void);
+
+    double m_range;                 // meters
+    double m_maxSpeed;              // meters per second, of any PHY
+    ns3::Time m_positionTick;       // batched mobility: positions jump once per tick
+    ns3::Time m_rebuildInterval;
+
+    ns3::Ptr<ns3::PropagationLossModel> m_loss;
+    ns3::Ptr<ns3::PropagationDelayModel> m_delay;
+
+    // grid, cells in row major order, PHY indexes in channel order inside a cell
+    std::vector<ns3::Ptr<ns3::YansWifiPhy>> m_phys;
+    ns3::Time m_builtAt;
+    double m_minX;
+    double m_minY;
+    double m_cell;                  // cell side, meters
+    uint32_t m_columns;
+    uint32_t m_rows;
+    std::vector<uint32_t> m_cellStart;     // m_columns * m_rows + 1 offsets into m_cellPhys
+    std::vector<uint32_t> m_cellPhys;
+    std::vector<uint32_t> m_candidates;
+};
+
+
+/* YansWifiPhy that transmits through a RangeYansWifiChannel */
+class RangeYansWifiPhy : public ns3::YansWifiPhy {
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    RangeYansWifiPhy();
+    virtual ~RangeYansWifiPhy();
+
+    virtual void StartTx(ns3::Ptr<ns3::WifiPpdu> ppdu);
+};
+
+
+/* YansWifiPhyHelper::Default() creating RangeYansWifiPhy */
+class RangeYansWifiPhyHelper : public ns3::YansWifiPhyHelper {
+public:
+    RangeYansWifiPhyHelper();
+};
+
+#endif /* RANGE_WIFI_CHANNEL_H */
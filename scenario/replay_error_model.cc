@@ -0,0 +1,170 @@
+#include <cstring>
+#include <fstream>
+#include "replay_error_model.h"
+#include "ns3/boolean.h"
+#include "ns3/csma-module.h"
+#include "ns3/enum.h"
+#include "ns3/internet-module.h"
+#include "ns3/ppp-header.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+NS_OBJECT_ENSURE_REGISTERED(ReplayErrorModel);
+
+
+static const char SCHEDULE_MAGIC[8] = { 'D', 'R', 'O', 'P', 'S', 'C', 'H', '1' };
+
+
+DropSchedule::DropSchedule(const std::string & path, uint8_t site) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    char magic[8];
+    uint64_t count = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, SCHEDULE_MAGIC, sizeof(magic)) != 0 ||
+        !in.read(reinterpret_cast<char *>(&count), sizeof(count))) {
+        NS_FATAL_ERROR("Cannot read drop schedule " << path << ", expected logparser --schedule=true output");
+    }
+    // the count is checked against the file size before anything is allocated for it
+    std::streampos start = in.tellg();
+    in.seekg(0, std::ios::end);
+    uint64_t remaining = uint64_t(in.tellg() - start);
+    in.seekg(start);
+    if (count > remaining / sizeof(DropScheduleRecord)) {
+        NS_FATAL_ERROR("Drop schedule " << path << " is truncated: " << count << " records in the header, "
+                       << remaining / sizeof(DropScheduleRecord) << " in the file");
+    }
+    std::vector<DropScheduleRecord> all(count);
+    if (!in.read(reinterpret_cast<char *>(all.data()), count * sizeof(DropScheduleRecord))) {
+        NS_FATAL_ERROR("Drop schedule " << path << " is truncated");
+    }
+    for (const DropScheduleRecord & record : all) {
+        if (record.site == site) {
+            records.push_back(record);
+        }
+    }
+    used.assign(records.size(), false);
+}
+
+
+TypeId ReplayErrorModel::GetTypeId(void) {
+    static TypeId tid = TypeId("ReplayErrorModel")
+        .SetParent<ErrorModel>()
+        .AddConstructor<ReplayErrorModel>()
+        .AddAttribute("Match", "What a packet must share with a scheduled drop",
+                      EnumValue(MATCH_TIME),
+                      MakeEnumAccessor(&ReplayErrorModel::m_match),
+                      MakeEnumChecker(MATCH_TIME, "time", MATCH_SEQ, "seq"))
+        .AddAttribute("Window", "time: arrival at most this long after the drop; seq: this far from it either way",
+                      TimeValue(MicroSeconds(1)),
+                      MakeTimeAccessor(&ReplayErrorModel::m_window),
+                      MakeTimeChecker())
+        .AddAttribute("Ethernet", "Packets start with an Ethernet header (csma), else a PPP header",
+                      BooleanValue(false),
+                      MakeBooleanAccessor(&ReplayErrorModel::m_ethernet),
+                      MakeBooleanChecker());
+    return tid;
+}
+
+
+ReplayErrorModel::ReplayErrorModel()
+    : m_match(MATCH_TIME),
+      m_window(MicroSeconds(1)),
+      m_ethernet(false),
+      m_cursor(0),
+      m_matched(0) {
+}
+
+
+ReplayErrorModel::~ReplayErrorModel() {
+}
+
+
+void ReplayErrorModel::SetSchedule(Ptr<DropSchedule> schedule) {
+    m_schedule = schedule;
+    m_cursor = 0;
+}
+
+
+uint64_t ReplayErrorModel::GetMatched(void) const {
+    return m_matched;
+}
+
+
+bool ReplayErrorModel::TcpSeq(Ptr<const Packet> p, uint32_t & seq) const {
+    Ptr<Packet> copy = p->Copy();
+    if (m_ethernet) {
+        EthernetHeader ethernet;
+        copy->RemoveHeader(ethernet);
+        if (ethernet.GetLengthType() != Ipv4L3Protocol::PROT_NUMBER) {
+            return false;
+        }
+    }
+    else {
+        PppHeader ppp;
+        copy->RemoveHeader(ppp);
+        if (ppp.GetProtocol() != 0x0021) {
+            return false;
+        }
+    }
+    Ipv4Header ip;
+    copy->RemoveHeader(ip);
+    if (ip.GetProtocol() != TcpL4Protocol::PROT_NUMBER) {
+        return false;
+    }
+    TcpHeader tcp;
+    copy->RemoveHeader(tcp);
+    seq = tcp.GetSequenceNumber().GetValue();
+    return true;
+}
+
+
+bool ReplayErrorModel::DoCorrupt(Ptr<Packet> p) {
+    if (!m_schedule) {
+        return false;
+    }
+    std::vector<DropScheduleRecord> & records = m_schedule->records;
+    std::vector<bool> & used = m_schedule->used;
+    int64_t now = Simulator::Now().GetNanoSeconds();
+    int64_t window = m_window.GetNanoSeconds();
+
+    // skip the drops that no packet can match any more
+    while (m_cursor < records.size() && records[m_cursor].nanoseconds + window <= now) {
+        m_cursor++;
+    }
+
+    bool drop = false;
+    if (m_match == MATCH_TIME) {
+        // recorded times are cut to the capture's precision, the arrival is at or after them
+        for (size_t i = m_cursor; i < records.size() && records[i].nanoseconds <= now; ++i) {
+            if (!used[i]) {
+                used[i] = true;
+                drop = true;
+                break;
+            }
+        }
+    }
+    else {
+        uint32_t seq;
+        if (TcpSeq(p, seq)) {
+            for (size_t i = m_cursor; i < records.size() && records[i].nanoseconds - window <= now; ++i) {
+                if (!used[i] && records[i].hasSeq && records[i].seq == seq) {
+                    used[i] = true;
+                    drop = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (drop) {
+        m_matched++;
+    }
+    while (m_cursor < records.size() && used[m_cursor]) {
+        m_cursor++;
+    }
+    return drop;
+}
+
+
+void ReplayErrorModel::DoReset(void) {
+    m_cursor = 0;
+}
@@ -0,0 +1,81 @@
+#ifndef REPLAY_ERROR_MODEL_H
+#define REPLAY_ERROR_MODEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ns3/error-model.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+
+/*
+ * Drop schedule file, written by logparser --schedule=true:
+ *
+ *   char     magic[8]      "DROPSCH1"
+ *   uint64_t records
+ *   records sorted by time, 16 bytes each, little endian:
+ *     int64_t  nanoseconds
+ *     uint32_t seq         TCP sequence number of the dropped segment
+ *     uint8_t  site        0 receiver, 1 inter
+ *     uint8_t  hasSeq
+ *     uint16_t reserved
+ */
+struct DropScheduleRecord {
+    int64_t nanoseconds;
+    uint32_t seq;
+    uint8_t site;
+    uint8_t hasSeq;
+    uint16_t reserved;
+};
+
+
+/* the records of one drop site, shared by the error models of its devices */
+class DropSchedule : public ns3::SimpleRefCount<DropSchedule> {
+public:
+    /* records of site in path, NS_FATAL_ERROR when the file is not a schedule */
+    DropSchedule(const std::string & path, uint8_t site);
+
+    std::vector<DropScheduleRecord> records;
+    std::vector<bool> used;
+};
+
+
+/*
+ * Replays a recorded drop timeline: a packet is dropped when it arrives
+ * within Window after the time of a scheduled drop (Match=time) or, for a
+ * TCP segment, when a scheduled drop within Window of its arrival has its
+ * sequence number (Match=seq). A cursor moves along the sorted schedule
+ * with the simulation time, so a packet costs a comparison or two
+ * whatever the length of the schedule. Every scheduled drop is used once.
+ */
+class ReplayErrorModel : public ns3::ErrorModel {
+public:
+    enum Match {
+        MATCH_TIME,
+        MATCH_SEQ
+    };
+
+    static ns3::TypeId GetTypeId(void);
+
+    ReplayErrorModel();
+    virtual ~ReplayErrorModel();
+
+    void SetSchedule(ns3::Ptr<DropSchedule> schedule);
+    uint64_t GetMatched(void) const;
+
+private:
+    virtual bool DoCorrupt(ns3::Ptr<ns3::Packet> p);
+    virtual void DoReset(void);
+
+    /* sequence number of a TCP segment below the link header, false for anything else */
+    bool TcpSeq(ns3::Ptr<const ns3::Packet> p, uint32_t & seq) const;
+
+    ns3::Ptr<DropSchedule> m_schedule;
+    Match m_match;
+    ns3::Time m_window;
+    bool m_ethernet;                // csma device, else PPP
+    size_t m_cursor;                // first record that can still match
+    uint64_t m_matched;
+};
+
+#endif /* REPLAY_ERROR_MODEL_H */
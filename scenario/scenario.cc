@@ -0,0 +1,395 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+#include "scenario.h"
+#include "drop_stats.h"
+#include "drop_matrix.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("scenario");
+
+// One binary for every topology: the sender access network (none, csma,
+// wifi), the receiver access network (none, csma) and the transport (udp,
+// tcp) are chosen on the command line, e.g.
+//
+//   ./waf --run "scenario --sender=csma --receiver=csma --transport=tcp"
+//
+// runs what sender_csma_p2p_csma_receiver_tcp used to run.
+
+
+std::string ScenarioName(const ScenarioConfig & config) {
+    std::string name = "sender_";
+    if (config.sender != "none") {
+        name += config.sender + "_";
+    }
+    name += "p2p_";
+    if (config.receiver != "none") {
+        name += config.receiver + "_";
+    }
+    return name + "receiver_" + config.transport;
+}
+
+
+std::string OutputPrefix(const ScenarioConfig & config) {
+    return config.outputDir + "/" + ScenarioName(config);
+}
+
+
+/* ns-3 TypeId of a --scheduler name, empty if unknown */
+static std::string SchedulerType(const std::string & name) {
+    if (name == "map") {
+        return "ns3::MapScheduler";
+    }
+    if (name == "heap") {
+        return "ns3::HeapScheduler";
+    }
+    if (name == "calendar") {
+        return "ns3::CalendarScheduler";
+    }
+    if (name == "list") {
+        return "ns3::ListScheduler";
+    }
+    if (name == "dary") {
+        return "DaryHeapScheduler";
+    }
+    return "";
+}
+
+
+static void CheckConfig(const ScenarioConfig & config) {
+    if (config.sender != "none" && config.sender != "csma" && config.sender != "wifi") {
+        NS_FATAL_ERROR("Unknown sender access network " << config.sender << " (none, csma, wifi)");
+    }
+    if (config.receiver != "none" && config.receiver != "csma") {
+        NS_FATAL_ERROR("Unknown receiver access network " << config.receiver << " (none, csma)");
+    }
+    if (config.transport != "udp" && config.transport != "tcp") {
+        NS_FATAL_ERROR("Unknown transport " << config.transport << " (udp, tcp)");
+    }
+    if (config.pcapWriter != "async" && config.pcapWriter != "ns3") {
+        NS_FATAL_ERROR("Unknown pcap writer " << config.pcapWriter << " (async, ns3)");
+    }
+    if (SchedulerType(config.scheduler).empty()) {
+        NS_FATAL_ERROR("Unknown scheduler " << config.scheduler << " (map, heap, calendar, list, dary)");
+    }
+    if (config.verbose != "stats" && config.verbose != "info" && config.verbose != "all" && config.verbose != "none") {
+        NS_FATAL_ERROR("Unknown verbose level " << config.verbose << " (stats, info, all, none)");
+    }
+    if (config.pcapSnapLen == 0 || config.pcapSample == 0) {
+        NS_FATAL_ERROR("pcapSnapLen and pcapSample must be at least 1");
+    }
+    if (config.pcapWriter == "ns3" && (config.pcapSnapLen != 65535 || config.pcapSample != 1)) {
+        NS_FATAL_ERROR("pcapSnapLen and pcapSample need --pcapWriter=async");
+    }
+    if (config.distributed && config.flowMonitor) {
+        NS_FATAL_ERROR("flowMonitor is not supported with --distributed, each rank would only see half of every flow");
+    }
+    if (config.dropBin <= 0) {
+        NS_FATAL_ERROR("dropBin must be positive");
+    }
+    if ((config.seconds + 1) / config.dropBin >= DropStats::MAX_BINS) {
+        NS_FATAL_ERROR("dropBin " << config.dropBin << " gives more than " << DropStats::MAX_BINS << " drop stats bins in "
+                       << config.seconds + 1 << " s, use a wider bin");
+    }
+    if (config.flowInterval <= 0) {
+        NS_FATAL_ERROR("flowInterval must be positive");
+    }
+    if (config.udpApp != "echo" && config.udpApp != "load") {
+        NS_FATAL_ERROR("Unknown udp application " << config.udpApp << " (echo, load)");
+    }
+    if (config.loadMode != "cbr" && config.loadMode != "poisson" && config.loadMode != "burst") {
+        NS_FATAL_ERROR("Unknown load mode " << config.loadMode << " (cbr, poisson, burst)");
+    }
+    if (config.udpApp == "load" && (config.loadBurst == 0 || config.senderPacketSize < 12)) {
+        NS_FATAL_ERROR("udpApp=load needs loadBurst of at least 1 and senderPacketSize of at least 12");
+    }
+    if (config.udpApp == "load" && DataRate(config.loadRate).GetBitRate() == 0) {
+        NS_FATAL_ERROR("loadRate must be positive");
+    }
+    TypeId tcpVariant;
+    if (!TypeId::LookupByNameFailSafe("ns3::Tcp" + config.tcpVariant, &tcpVariant) || !tcpVariant.IsChildOf(TcpCongestionOps::GetTypeId())) {
+        NS_FATAL_ERROR("Unknown tcp variant " << config.tcpVariant << " (NewReno, Cubic, Westwood, Vegas, Illinois, ..., any ns3::Tcp<variant> congestion control of this ns-3)");
+    }
+    if (config.latency && (config.transport != "udp" || config.udpApp != "echo")) {
+        NS_FATAL_ERROR("latency needs --transport=udp --udpApp=echo");
+    }
+    if (config.tcpTrace && config.transport != "tcp") {
+        NS_FATAL_ERROR("tcpTrace needs --transport=tcp");
+    }
+    if (config.tcpTraceInterval < 0) {
+        NS_FATAL_ERROR("tcpTraceInterval must not be negative");
+    }
+    if (config.sender == "wifi" && config.wifiNumber == 0) {
+        NS_FATAL_ERROR("wifiNumber must be at least 1");
+    }
+    if ((config.sender == "csma" || config.receiver == "csma") && config.csmaNumber == 0) {
+        NS_FATAL_ERROR("csmaNumber must be at least 1");
+    }
+    if (config.lossModel != "rate" && config.lossModel != "bernoulli" && config.lossModel != "gilbert" && config.lossModel != "replay") {
+        NS_FATAL_ERROR("Unknown loss model " << config.lossModel << " (rate, bernoulli, gilbert, replay)");
+    }
+    if (config.lossModel == "replay" && config.lossSchedule.empty()) {
+        NS_FATAL_ERROR("lossModel=replay needs a --lossSchedule file");
+    }
+    if (config.replayMatch != "time" && config.replayMatch != "seq") {
+        NS_FATAL_ERROR("Unknown replay match " << config.replayMatch << " (time, seq)");
+    }
+    if (config.replayWindow <= 0) {
+        NS_FATAL_ERROR("replayWindow must be positive");
+    }
+    if (config.lossBurst < 1) {
+        NS_FATAL_ERROR("lossBurst must be at least 1 packet");
+    }
+    if (config.mobility != "walk" && config.mobility != "batched") {
+        NS_FATAL_ERROR("Unknown mobility " << config.mobility << " (walk, batched)");
+    }
+    if (config.mobilityTick <= 0) {
+        NS_FATAL_ERROR("mobilityTick must be positive");
+    }
+    if (config.wifiRange < 0) {
+        NS_FATAL_ERROR("wifiRange must not be negative");
+    }
+    if (config.senderShare < 0 || config.senderShare > 1) {
+        NS_FATAL_ERROR("senderShare must be between 0 and 1");
+    }
+}
+
+
+/* resident set size from /proc, 0 where it is not available */
+static uint64_t ResidentBytes(void) {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+
+/* stats and none enable no log component at all */
+static void EnableLogging(const ScenarioConfig & config) {
+#ifndef NS3_LOG_ENABLE
+    if (config.verbose == "all" || config.verbose == "info") {
+        std::cerr << "NS_LOG is compiled out of this build, --verbose=" << config.verbose << " prints nothing\n";
+    }
+#endif
+    LogLevel level;
+    if (config.verbose == "all") {
+        level = LOG_LEVEL_ALL;
+    }
+    else if (config.verbose == "info") {
+        level = LOG_LEVEL_INFO;
+    }
+    else {
+        return;
+    }
+
+    LogComponentEnable("scenario", level);
+    if (config.transport == "tcp") {
+        LogComponentEnable("TcpL4Protocol", level);
+        LogComponentEnable("PacketSink", level);
+    }
+    else {
+        LogComponentEnable("UdpEchoClientApplication", level);
+        LogComponentEnable("UdpEchoServerApplication", level);
+    }
+}
+
+
+int main(int argc, char *argv[]) {
+
+    ScenarioConfig config;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("sender", "Sender access network: none, csma, wifi", config.sender);
+    cmd.AddValue("receiver", "Receiver access network: none, csma", config.receiver);
+    cmd.AddValue("transport", "Transport: udp (UdpEcho), tcp (OnOff)", config.transport);
+    cmd.AddValue("verbose", "stats (no logging, counters printed at the end), info, all (NS_LOG levels), none", config.verbose);
+    cmd.AddValue("tracing", "Enable tracing", config.tracing);
+    cmd.AddValue("pcapWriter", "Pcap writer: async (background thread), ns3 (PcapFileWrapper)", config.pcapWriter);
+    cmd.AddValue("pcapSnapLen", "Bytes kept of every captured packet, e.g. 64 for headers only", config.pcapSnapLen);
+    cmd.AddValue("pcapSample", "Device pcaps keep 1 packet in pcapSample", config.pcapSample);
+    cmd.AddValue("seconds", "Simulation duration seconds", config.seconds);
+    cmd.AddValue("scheduler", "Event scheduler: map, heap, calendar, list, dary (4-ary heap)", config.scheduler);
+    cmd.AddValue("profile", "Profile the event loop, print the profile's top N handler types at exit, 0 for off", config.profile);
+    cmd.AddValue("outputDir", "Directory for every output file of this run", config.outputDir);
+    cmd.AddValue("summary", "Write a one-row csv summary at the end of the run", config.summary);
+    cmd.AddValue("dropStats", "Write per drop site, time binned loss counters at the end of the run", config.dropStats);
+    cmd.AddValue("dropBin", "Drop stats bin width in seconds", config.dropBin);
+    cmd.AddValue("dropLog", "Print a ReceiverRxDrop/InterRxDrop line for every drop", config.dropLog);
+    cmd.AddValue("dropMatrix", "Count the drops of every device by layer and reason (phy, mac, queue, traffic control, ip)", config.dropMatrix);
+    cmd.AddValue("flowMonitor", "Write per flow FlowMonitor snapshots every flowInterval seconds", config.flowMonitor);
+    cmd.AddValue("flowInterval", "Flow monitor snapshot interval in seconds", config.flowInterval);
+    cmd.AddValue("latency", "Write per flow RTT and one-way delay percentiles of the udp echo packets", config.latency);
+    cmd.AddValue("hopLatency", "Write per segment (access network, queues, p2p link) delay percentiles of the sender to receiver packets", config.hopLatency);
+    cmd.AddValue("tcpTrace", "Write the tcp senders' cwnd, RTT, bytes in flight and retransmissions to binary files", config.tcpTrace);
+    cmd.AddValue("tcpTraceInterval", "Seconds between two tcp trace records of a value, 0 for every change", config.tcpTraceInterval);
+    cmd.AddValue("distributed", "Run on 2 MPI ranks split at the p2p link (mpirun -np 2)", config.distributed);
+    cmd.AddValue("p2pDataRate", "Point to point DataRate", config.p2pDataRate);
+    cmd.AddValue("p2pDelay", "Point to point Delay", config.p2pDelay);
+    cmd.AddValue("wifiNumber", "Wifi nodes number", config.wifiNumber);
+    cmd.AddValue("mobility", "Wifi station mobility: walk (a RandomWalk2d model each) or batched (one array updated every mobilityTick)", config.mobility);
+    cmd.AddValue("mobilityTick", "Seconds between two batched mobility updates", config.mobilityTick);
+    cmd.AddValue("wifiRange", "Meters a wifi transmission is delivered to, 0 for every station", config.wifiRange);
+    cmd.AddValue("senderShare", "Share of the sender csma or wifi nodes that send, 0 for the last one only", config.senderShare);
+    cmd.AddValue("csmaNumber", "Csma nodes number", config.csmaNumber);
+    cmd.AddValue("csmaDataRate", "Csma DataRate", config.csmaDataRate);
+    cmd.AddValue("csmaDelay", "Csma Delay", config.csmaDelay);
+    cmd.AddValue("udpApp", "Udp application: echo (UdpEcho), load (paced UdpLoadGenerator and sink)", config.udpApp);
+    cmd.AddValue("senderInterval", "Send interval (udp)", config.senderInterval);
+    cmd.AddValue("loadMode", "Packet gaps: cbr, poisson, burst (udp load)", config.loadMode);
+    cmd.AddValue("loadRate", "Send DataRate of every sender (udp load)", config.loadRate);
+    cmd.AddValue("loadBurst", "Packets per burst (udp load)", config.loadBurst);
+    cmd.AddValue("tcpVariant", "Tcp congestion control, ns3::Tcp<variant>: NewReno, Cubic, Westwood, Vegas, Illinois, HighSpeed, Hybla, Scalable, Veno, Bic, Yeah, Htcp, Lp, Ledbat, ...", config.tcpVariant);
+    cmd.AddValue("senderMaxBytes", "Bytes each sender sends before it stops, 0 for no limit (tcp)", config.senderMaxBytes);
+    cmd.AddValue("senderOnTime", "Sender OnOffTime OnTime (tcp)", config.senderOnTime);
+    cmd.AddValue("senderOffTime", "Sender OnOffTime OffTime (tcp)", config.senderOffTime);
+    cmd.AddValue("senderPacketSize", "Send packet size", config.senderPacketSize);
+    cmd.AddValue("senderDataRate", "Send DataRate (tcp)", config.senderDataRate);
+    cmd.AddValue("receiverRanVarMin", "Receiver RanVar Min", config.receiverRanVarMin);
+    cmd.AddValue("receiverRanVarMax", "Receiver RanVar Max", config.receiverRanVarMax);
+    cmd.AddValue("receiverErrorRate", "Rate in receiver RateErrorModel", config.receiverErrorRate);
+    cmd.AddValue("interRanVarMin", "Inter RanVar Min", config.interRanVarMin);
+    cmd.AddValue("interRanVarMax", "Inter RanVar Max", config.interRanVarMax);
+    cmd.AddValue("interErrorRate", "Rate in inter RateErrorModel", config.interErrorRate);
+    cmd.AddValue("lossModel", "Error model: rate (RateErrorModel), bernoulli or gilbert (same loss rates, one draw per loss), replay", config.lossModel);
+    cmd.AddValue("lossBurst", "Mean packets per loss burst (gilbert)", config.lossBurst);
+    cmd.AddValue("lossSchedule", "Drop schedule to replay, from logparser --schedule=true (replay)", config.lossSchedule);
+    cmd.AddValue("replayMatch", "Drop a packet by arrival time or tcp sequence number: time, seq (replay)", config.replayMatch);
+    cmd.AddValue("replayWindow", "Seconds a packet may be off a scheduled drop (replay)", config.replayWindow);
+    cmd.Parse(argc, argv);
+    CheckConfig(config);
+    EnableDistributed(config, &argc, &argv);
+
+    Time::SetResolution(Time::NS);
+    SystemPath::MakeDirectories(config.outputDir);
+
+    EnableLogging(config);
+
+    ObjectFactory scheduler;
+    if (config.profile > 0) {
+        // the profiler keeps the events in the --scheduler event set
+        scheduler.SetTypeId("ProfilingScheduler");
+        scheduler.Set("Scheduler", TypeIdValue(TypeId::LookupByName(SchedulerType(config.scheduler))));
+        scheduler.Set("Rows", UintegerValue(config.profile));
+    }
+    else {
+        scheduler.SetTypeId(SchedulerType(config.scheduler));
+    }
+    Simulator::SetScheduler(scheduler);
+
+
+    /* nodes topology */
+    NS_LOG_INFO("Creating Topology");
+    RunStats runStats;
+    uint64_t residentBefore = ResidentBytes();
+    Topology topology;
+    BuildTopology(config, topology);
+
+
+    /* network protocol stack */
+    InstallInternetStack(config, topology);
+
+
+    /* application */
+    InstallApplications(config, topology);
+
+
+    /* loss */
+    InstallLoss(config, topology);
+
+
+    /* tracing */
+    EnableTracing(config, topology);
+
+    bool stats = config.verbose == "stats";
+    DropStats dropStats(Seconds(config.dropBin), Seconds(config.seconds + 1));
+    if (config.dropStats || config.summary || stats) {
+        dropStats.AddSite(RECEIVER_DROP, topology.receiverDevice);
+        for (uint32_t i = 0; i < topology.interDevices.GetN(); ++i) {
+            dropStats.AddSite(INTER_DROP, topology.interDevices.Get(i));
+        }
+    }
+    DropMatrix dropMatrix;
+    if (config.dropMatrix) {
+        dropMatrix.Install();
+    }
+    if (config.summary || stats) {
+        InstallSummary(config, topology);
+    }
+    if (config.flowMonitor) {
+        InstallFlowMonitor(config, topology);
+    }
+    if (config.tcpTrace) {
+        InstallTcpTrace(config, topology);
+    }
+    bool latency = config.latency || (stats && config.transport == "udp" && config.udpApp == "echo");
+    if (latency) {
+        InstallLatency(config, topology);
+    }
+    if (config.hopLatency) {
+        InstallHopLatency(config, topology);
+    }
+
+
+    runStats.nodes = NodeList::GetNNodes();
+    uint64_t residentAfter = ResidentBytes();
+    runStats.setupBytes = residentAfter > residentBefore ? residentAfter - residentBefore : 0;
+
+
+    /* simulation */
+    Simulator::Stop(Seconds(config.seconds + 1));
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    runStats.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    runStats.events = Simulator::GetEventCount();
+    CloseTracing();
+    CloseFlowMonitor();
+    CloseTcpTrace();
+    CloseLoss();
+    ReduceSummary(config, dropStats, runStats);
+    if (latency) {
+        ReduceLatency(config);
+    }
+    if (config.hopLatency) {
+        ReduceHopLatency(config);
+    }
+    if (config.dropMatrix && config.distributed) {
+        dropMatrix.Reduce();
+    }
+    if (config.dropStats && Rank() == 0) {
+        dropStats.Write(OutputPrefix(config) + "_drops.csv");
+    }
+    if (config.dropMatrix && Rank() == 0) {
+        dropMatrix.Write(OutputPrefix(config) + "_drop_matrix.csv");
+    }
+    if (config.summary && Rank() == 0) {
+        WriteSummary(config, dropStats, runStats, OutputPrefix(config) + "_summary.csv");
+    }
+    if (config.latency && Rank() == 0) {
+        WriteLatency(OutputPrefix(config) + "_latency.csv");
+    }
+    if (config.hopLatency && Rank() == 0) {
+        WriteHopLatency(OutputPrefix(config) + "_hops.csv");
+    }
+    if (stats && Rank() == 0) {
+        PrintSummary(config, dropStats, runStats);
+        if (latency) {
+            PrintLatency();
+        }
+        if (config.hopLatency) {
+            PrintHopLatency();
+        }
+        if (config.dropMatrix) {
+            dropMatrix.Print();
+        }
+    }
+    Simulator::Destroy();
+    DisableDistributed(config);
+
+
+    return 0;
+}
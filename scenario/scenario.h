@@ -0,0 +1,208 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/yans-wifi-helper.h"
+
+class DropStats;
+
+// ======================================================
+//
+//          sender                          receiver
+//  n2  n3  n4  n0      ---     n1  n5  n6  n7
+//      none            p2p         none
+//      LAN             10.1.1.x    LAN
+//      Wifi                        10.1.3.x
+//      10.1.2.x
+//
+// ======================================================
+
+
+/* simulator cost of a run, measured around the setup and Simulator::Run() */
+struct RunStats {
+    uint64_t events = 0;
+    double wallSeconds = 0.0;
+    uint32_t nodes = 0;
+    uint64_t setupBytes = 0;        // resident memory added by building the scenario
+};
+
+
+/* scenario options, one field per command line value */
+struct ScenarioConfig {
+    std::string sender = "none";        // sender access network: none, csma, wifi
+    std::string receiver = "none";      // receiver access network: none, csma
+    std::string transport = "udp";      // udp (UdpEcho) or tcp (OnOff + PacketSink)
+
+    std::string verbose = "stats";      // stats (no logging, trace source counters), info, all, none
+    bool tracing = false;
+    double seconds = 10.0;
+    std::string scheduler = "map";      // event set: map, heap, calendar, list, dary
+    uint32_t profile = 0;               // handler types in the event loop profile printed at exit, 0: off
+    std::string outputDir = "scratch";  // every file of the run is written here
+    bool summary = false;               // write <outputDir>/<name>_summary.csv
+    bool dropStats = false;             // write <outputDir>/<name>_drops.csv
+    double dropBin = 1.0;               // seconds per drop stats bin
+    bool dropLog = false;               // print a line for every drop
+    bool dropMatrix = false;            // write <outputDir>/<name>_drop_matrix.csv, every drop source of every device
+    bool flowMonitor = false;           // write <outputDir>/<name>_flows.csv
+    double flowInterval = 1.0;          // seconds between flow monitor snapshots
+    bool latency = false;               // write <outputDir>/<name>_latency.csv (udp echo)
+    bool hopLatency = false;            // write <outputDir>/<name>_hops.csv, per segment delays sender to receiver
+    bool tcpTrace = false;              // write <outputDir>/<name>_{cwnd,rtt,inflight,retx}.bin
+    double tcpTraceInterval = 0.0;      // seconds between two tcp trace records of a value, 0: every change
+    bool distributed = false;           // MPI: sender side on rank 0, receiver side on rank 1
+    std::string pcapWriter = "async";   // async (background thread) or ns3 (PcapFileWrapper)
+    uint32_t pcapSnapLen = 65535;       // bytes kept of every captured packet
+    uint32_t pcapSample = 1;            // device pcaps keep 1 packet in pcapSample
+
+    std::string p2pDataRate = "5Mbps";
+    std::string p2pDelay = "50ms";
+
+    uint32_t wifiNumber = 3;
+    std::string mobility = "walk";      // wifi stations: walk (RandomWalk2dMobilityModel) or batched
+    double mobilityTick = 0.1;          // seconds between two batched position updates
+    double wifiRange = 0.0;             // meters a transmission reaches, 0: every station (full Yans channel)
+    double senderShare = 0.0;           // share of the sender access nodes that send, 0: the last one only
+
+    uint32_t csmaNumber = 3;
+    std::string csmaDataRate = "100Mbps";
+    uint32_t csmaDelay = 6560;
+
+    // udp sender
+    std::string udpApp = "echo";        // echo (UdpEcho, one packet per senderInterval) or load (UdpLoadGenerator)
+    double senderInterval = 1.0;
+    std::string loadMode = "cbr";       // load: cbr, poisson, burst
+    std::string loadRate = "1Mbps";     // load: mean rate of every sender
+    uint32_t loadBurst = 10;            // load: packets per burst
+    // tcp sender
+    std::string tcpVariant = "NewReno"; // congestion control, ns3::Tcp<variant>
+    uint64_t senderMaxBytes = 0;        // bytes each sender sends before it stops, 0: no limit
+    std::string senderOnTime = "1.0";
+    std::string senderOffTime = "1.0";
+    std::string senderDataRate = "1Mbps";
+    uint32_t senderPacketSize = 1024;
+
+    std::string receiverRanVarMin = "0.8";
+    std::string receiverRanVarMax = "1.0";
+    double receiverErrorRate = 0.001;
+
+    std::string interRanVarMin = "0.8";
+    std::string interRanVarMax = "1.0";
+    double interErrorRate = 0.001;
+
+    std::string lossModel = "rate";     // rate (RateErrorModel), bernoulli or gilbert (skip-ahead), replay
+    double lossBurst = 4.0;             // gilbert: mean packets per bad state
+    std::string lossSchedule = "";      // replay: drop schedule from logparser --schedule=true
+    std::string replayMatch = "time";   // replay: time or seq (tcp sequence number)
+    double replayWindow = 1e-6;         // replay: seconds a packet may be off the scheduled drop
+};
+
+
+/* nodes, devices and helpers of one built topology */
+struct Topology {
+    // p2p
+    ns3::NodeContainer p2pNodes;
+    ns3::PointToPointHelper p2p;
+    ns3::NetDeviceContainer p2pDevices;
+    ns3::Ipv4InterfaceContainer p2pInterfaces;
+
+    // sender side: n0 followed by the sender access nodes
+    ns3::NodeContainer senderNodes;
+    ns3::NodeContainer wifiSenderStaNodes;
+    ns3::NetDeviceContainer senderDevices;
+    ns3::CsmaHelper csmaSender;
+    ns3::YansWifiPhyHelper wifiSenderPhy;
+
+    // receiver side: n1 followed by the receiver access nodes
+    ns3::NodeContainer receiverNodes;
+    ns3::NetDeviceContainer receiverDevices;
+    ns3::CsmaHelper csmaReceiver;
+
+    // endpoints
+    ns3::Ptr<ns3::Node> senderNode;
+    ns3::NodeContainer activeSenderNodes;    // senderNode first, then the other --senderShare nodes
+    ns3::Ptr<ns3::NetDevice> senderDevice;
+    ns3::Ptr<ns3::Node> receiverNode;
+    ns3::Ptr<ns3::NetDevice> receiverDevice;
+    ns3::Ipv4Address receiverAddress;
+
+    // p2p devices carrying the inter error model
+    ns3::NetDeviceContainer interDevices;
+
+    // applications
+    ns3::ApplicationContainer senderApps;
+    ns3::ApplicationContainer receiverApps;
+};
+
+
+/* scenario name, e.g. sender_csma_p2p_csma_receiver_tcp */
+std::string ScenarioName(const ScenarioConfig & config);
+
+/* <outputDir>/<scenario name>, the prefix of every output file */
+std::string OutputPrefix(const ScenarioConfig & config);
+
+/* distributed.cc */
+void EnableDistributed(const ScenarioConfig & config, int * argc, char *** argv);
+void DisableDistributed(const ScenarioConfig & config);
+uint32_t Rank(void);
+uint32_t SenderRank(const ScenarioConfig & config);
+uint32_t ReceiverRank(const ScenarioConfig & config);
+bool IsLocal(ns3::Ptr<ns3::Node> node);
+/* "" or _rank<n>, for files that every rank writes */
+std::string RankSuffix(const ScenarioConfig & config);
+
+/* topology.cc */
+void BuildTopology(const ScenarioConfig & config, Topology & topology);
+void InstallInternetStack(const ScenarioConfig & config, Topology & topology);
+
+/* applications.cc */
+void InstallApplications(const ScenarioConfig & config, Topology & topology);
+
+/* loss.cc */
+void InstallLoss(const ScenarioConfig & config, Topology & topology);
+/* --lossModel=replay: print how many scheduled drops were matched */
+void CloseLoss(void);
+
+/* tracing.cc */
+void EnableTracing(const ScenarioConfig & config, Topology & topology);
+void CloseTracing(void);
+
+/* flows.cc */
+void InstallFlowMonitor(const ScenarioConfig & config, Topology & topology);
+void CloseFlowMonitor(void);
+
+/* latency.cc: RTT and one-way delay histograms of the udp echo flows */
+void InstallLatency(const ScenarioConfig & config, Topology & topology);
+void ReduceLatency(const ScenarioConfig & config);
+void WriteLatency(const std::string & path);
+void PrintLatency(void);
+
+/* hop_latency.cc: per segment delay histograms of the sender to receiver packets */
+void InstallHopLatency(const ScenarioConfig & config, Topology & topology);
+void ReduceHopLatency(const ScenarioConfig & config);
+void WriteHopLatency(const std::string & path);
+void PrintHopLatency(void);
+
+/* tcp_trace.cc */
+/* end of the highest data segment a tcp socket has sent */
+struct TcpSendState {
+    uint32_t highestSent = 0;
+    bool sent = false;
+};
+/* whether a data segment of size bytes at seq was sent before, else it extends state */
+bool IsRetransmission(TcpSendState & state, uint32_t seq, uint32_t size);
+void InstallTcpTrace(const ScenarioConfig & config, Topology & topology);
+void CloseTcpTrace(void);
+
+/* summary.cc */
+void InstallSummary(const ScenarioConfig & config, Topology & topology);
+void WriteSummary(const ScenarioConfig & config, const DropStats & dropStats, const RunStats & runStats, const std::string & path);
+void PrintSummary(const ScenarioConfig & config, const DropStats & dropStats, const RunStats & runStats);
+void ReduceSummary(const ScenarioConfig & config, DropStats & dropStats, RunStats & runStats);
+
+#endif /* SCENARIO_H */
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "skip_error_model.h"
+#include "ns3/double.h"
+#include "ns3/packet.h"
+
+using namespace ns3;
+
+NS_OBJECT_ENSURE_REGISTERED(SkipErrorModel);
+NS_OBJECT_ENSURE_REGISTERED(SkipBernoulliErrorModel);
+NS_OBJECT_ENSURE_REGISTERED(SkipGilbertElliottErrorModel);
+
+
+/* a gap that no run reaches, small enough to add packets to */
+static const uint64_t NEVER = uint64_t(1) << 62;
+
+
+TypeId SkipErrorModel::GetTypeId(void) {
+    static TypeId tid = TypeId("SkipErrorModel")
+        .SetParent<ErrorModel>()
+        .AddAttribute("ErrorRate", "Byte error rate, as RateErrorModel's ErrorRate",
+                      DoubleValue(0.0),
+                      MakeDoubleAccessor(&SkipErrorModel::m_errorRate),
+                      MakeDoubleChecker<double>(0.0, 1.0))
+        .AddAttribute("RanVarMin", "Min of the uniform RanVar the RateErrorModel would draw",
+                      DoubleValue(0.0),
+                      MakeDoubleAccessor(&SkipErrorModel::m_ranVarMin),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("RanVarMax", "Max of the uniform RanVar the RateErrorModel would draw",
+                      DoubleValue(1.0),
+                      MakeDoubleAccessor(&SkipErrorModel::m_ranVarMax),
+                      MakeDoubleChecker<double>());
+    return tid;
+}
+
+
+SkipErrorModel::SkipErrorModel()
+    : m_candidateRate(0.0),
+      m_errorRate(0.0),
+      m_ranVarMin(0.0),
+      m_ranVarMax(1.0),
+      m_random(CreateObject<UniformRandomVariable>()),
+      m_largestSize(0) {
+}
+
+
+SkipErrorModel::~SkipErrorModel() {
+}
+
+
+int64_t SkipErrorModel::AssignStreams(int64_t stream) {
+    m_random->SetStream(stream);
+    return 1;
+}
+
+
+uint64_t SkipErrorModel::Geometric(double p) {
+    if (p >= 1.0) {
+        return 0;
+    }
+    if (p <= 0.0) {
+        return NEVER;
+    }
+    // 1 - U is in (0, 1], so the logarithm is finite
+    double failures = std::floor(std::log(1.0 - m_random->GetValue()) / std::log1p(-p));
+    return failures < double(NEVER) ? uint64_t(failures) : NEVER;
+}
+
+
+double SkipErrorModel::LossRate(uint32_t size) const {
+    double per = 1.0 - std::pow(1.0 - m_errorRate, double(size));
+    if (m_ranVarMax <= m_ranVarMin) {
+        return per > m_ranVarMin ? 1.0 : 0.0;
+    }
+    return std::min(1.0, std::max(0.0, (per - m_ranVarMin) / (m_ranVarMax - m_ranVarMin)));
+}
+
+
+bool SkipErrorModel::DoCorrupt(Ptr<Packet> p) {
+    uint32_t size = p->GetSize();
+    if (size > m_largestSize) {
+        m_largestSize = size;
+        m_candidateRate = LossRate(size);
+        CandidateRateChanged();
+    }
+    if (!NextCandidate()) {
+        return false;
+    }
+    // thinning: a smaller packet than the largest keeps its own loss rate
+    if (size == m_largestSize) {
+        return true;
+    }
+    return m_random->GetValue() * m_candidateRate < LossRate(size);
+}
+
+
+void SkipErrorModel::DoReset(void) {
+    m_largestSize = 0;
+    m_candidateRate = 0.0;
+}
+
+
+TypeId SkipBernoulliErrorModel::GetTypeId(void) {
+    static TypeId tid = TypeId("SkipBernoulliErrorModel")
+        .SetParent<SkipErrorModel>()
+        .AddConstructor<SkipBernoulliErrorModel>();
+    return tid;
+}
+
+
+SkipBernoulliErrorModel::SkipBernoulliErrorModel()
+    : m_skip(NEVER) {
+}
+
+
+SkipBernoulliErrorModel::~SkipBernoulliErrorModel() {
+}
+
+
+bool SkipBernoulliErrorModel::NextCandidate(void) {
+    if (m_skip > 0) {
+        m_skip--;
+        return false;
+    }
+    m_skip = Geometric(m_candidateRate);
+    return true;
+}
+
+
+void SkipBernoulliErrorModel::CandidateRateChanged(void) {
+    m_skip = Geometric(m_candidateRate);
+}
+
+
+TypeId SkipGilbertElliottErrorModel::GetTypeId(void) {
+    static TypeId tid = TypeId("SkipGilbertElliottErrorModel")
+        .SetParent<SkipErrorModel>()
+        .AddConstructor<SkipGilbertElliottErrorModel>()
+        .AddAttribute("BurstLength", "Mean packets per bad state",
+                      DoubleValue(4.0),
+                      MakeDoubleAccessor(&SkipGilbertElliottErrorModel::m_burstLength),
+                      MakeDoubleChecker<double>(1.0));
+    return tid;
+}
+
+
+SkipGilbertElliottErrorModel::SkipGilbertElliottErrorModel()
+    : m_burstLength(4.0),
+      m_started(false),
+      m_bad(false),
+      m_remaining(0) {
+}
+
+
+SkipGilbertElliottErrorModel::~SkipGilbertElliottErrorModel() {
+}
+
+
+/*
+ * bad share = bad sojourn / (bad sojourn + mean good sojourn) = candidate
+ * rate. A good state lasts one packet at least, so above a rate of
+ * burst / (burst + 1) the bad state lasts rate / (1 - rate) packets instead
+ * of burst; the good state is left with probability
+ * rate / (bad sojourn * (1 - rate)), 1 in that regime.
+ */
+double SkipGilbertElliottErrorModel::BadLength(void) const {
+    if (m_candidateRate >= 1.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return std::max(m_burstLength, m_candidateRate / (1.0 - m_candidateRate));
+}
+
+
+uint64_t SkipGilbertElliottErrorModel::Sojourn(void) {
+    if (m_bad) {
+        return 1 + Geometric(1.0 / BadLength());
+    }
+    if (m_candidateRate >= 1.0) {
+        return 1;
+    }
+    double leave = std::min(1.0, m_candidateRate / (BadLength() * (1.0 - m_candidateRate)));
+    return 1 + Geometric(leave);
+}
+
+
+bool SkipGilbertElliottErrorModel::NextCandidate(void) {
+    if (m_remaining == 0) {
+        m_bad = !m_bad;
+        m_remaining = Sojourn();
+    }
+    m_remaining--;
+    return m_bad;
+}
+
+
+void SkipGilbertElliottErrorModel::CandidateRateChanged(void) {
+    if (!m_started) {
+        // start in the stationary distribution, not after a long good state
+        m_started = true;
+        m_bad = Geometric(m_candidateRate) == 0;
+        m_remaining = Sojourn();
+    }
+    else if (m_remaining > 0) {
+        // both sojourns are geometric, drawing the rest of the current one again is exact
+        m_remaining = Sojourn();
+    }
+}
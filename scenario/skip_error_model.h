@@ -0,0 +1,110 @@
+#ifndef SKIP_ERROR_MODEL_H
+#define SKIP_ERROR_MODEL_H
+
+#include <cstdint>
+#include "ns3/error-model.h"
+#include "ns3/random-variable-stream.h"
+
+/*
+ * Packet loss decided by skipping ahead to the next candidate loss.
+ *
+ * The scenario's RateErrorModel draws RanVar = Uniform[RanVarMin, RanVarMax]
+ * for every packet and drops it when the draw is below the packet error
+ * rate 1 - (1 - ErrorRate)^size, i.e. with probability
+ *
+ *   clamp((per(size) - RanVarMin) / (RanVarMax - RanVarMin), 0, 1).
+ *
+ * These models take the same three values but draw only once per candidate
+ * loss: the number of packets up to the next candidate is sampled from a
+ * geometric distribution at the loss rate of the largest packet seen so
+ * far, and the packets in between only decrement a counter. A candidate of
+ * a smaller packet is kept with probability rate(size) / rate(largest), so
+ * every packet is still lost with the rate of its own size, as with
+ * RateErrorModel; the loss pattern is a different draw of the same
+ * distribution. A larger packet than any before raises the candidate rate
+ * and samples the gap again, which the geometric distribution allows as it
+ * has no memory.
+ */
+class SkipErrorModel : public ns3::ErrorModel {
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    SkipErrorModel();
+    virtual ~SkipErrorModel();
+
+    int64_t AssignStreams(int64_t stream);
+
+protected:
+    /* packets that fail before the first success of Bernoulli(p) trials */
+    uint64_t Geometric(double p);
+    /* loss probability of a packet of size bytes */
+    double LossRate(uint32_t size) const;
+
+    /* the candidate rate, of the largest packet seen */
+    double m_candidateRate;
+
+private:
+    virtual bool DoCorrupt(ns3::Ptr<ns3::Packet> p);
+    virtual void DoReset(void);
+
+    /* whether the next packet is a candidate loss */
+    virtual bool NextCandidate(void) = 0;
+    /* m_candidateRate has changed */
+    virtual void CandidateRateChanged(void) = 0;
+
+    double m_errorRate;             // per byte
+    double m_ranVarMin;
+    double m_ranVarMax;
+    ns3::Ptr<ns3::UniformRandomVariable> m_random;
+    uint32_t m_largestSize;
+};
+
+
+/* independent losses, the same distribution as the scenario's RateErrorModel */
+class SkipBernoulliErrorModel : public SkipErrorModel {
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    SkipBernoulliErrorModel();
+    virtual ~SkipBernoulliErrorModel();
+
+private:
+    virtual bool NextCandidate(void);
+    virtual void CandidateRateChanged(void);
+
+    uint64_t m_skip;                // packets before the next candidate
+};
+
+
+/*
+ * Bursty losses: a Gilbert-Elliott chain over packets, every packet of the
+ * bad state is a candidate and none of the good state. A bad state lasts
+ * BurstLength packets on average, and the good state is left at the rate
+ * that makes the share of bad packets the candidate rate, so the mean loss
+ * rate of every packet size is the one of SkipBernoulliErrorModel. Above a
+ * candidate rate of BurstLength / (BurstLength + 1) the good state lasts a
+ * single packet and the bad state grows to rate / (1 - rate) packets.
+ */
+class SkipGilbertElliottErrorModel : public SkipErrorModel {
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    SkipGilbertElliottErrorModel();
+    virtual ~SkipGilbertElliottErrorModel();
+
+private:
+    virtual bool NextCandidate(void);
+    virtual void CandidateRateChanged(void);
+
+    /* mean packets per bad state at the candidate rate */
+    double BadLength(void) const;
+    /* packets in a new sojourn of the current state */
+    uint64_t Sojourn(void);
+
+    double m_burstLength;           // mean packets per bad state
+    bool m_started;
+    bool m_bad;
+    uint64_t m_remaining;           // packets left in the current state
+};
+
+#endif /* SKIP_ERROR_MODEL_H */
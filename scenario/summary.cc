@@ -0,0 +1,239 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include "scenario.h"
+#include "drop_stats.h"
+#include "ns3/applications-module.h"
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+using namespace ns3;
+
+
+/* end of run counters, one instance per process */
+static struct {
+    uint64_t txPackets = 0;
+    uint64_t txBytes = 0;
+    uint64_t rxPackets = 0;
+    uint64_t rxBytes = 0;
+    uint64_t rttSamples = 0;
+    double rttSum = 0.0;            // seconds
+    uint64_t tcpSegments = 0;       // data segments sent by the tcp sockets, retransmissions included
+    uint64_t tcpRetransmissions = 0;
+    double lastRx = 0.0;            // seconds, the latest receive of the receiver application
+    std::unordered_map<uint64_t, Time> echoSent;   // udp packet uid -> send time
+    std::vector<TcpSendState> tcpSenders;
+} g_summary;
+
+
+static void SenderTx(Ptr<const Packet> p) {
+    g_summary.txPackets++;
+    g_summary.txBytes += p->GetSize();
+}
+
+
+/* the echo server sends the received packet back, so the uid survives the round trip */
+static void EchoClientTx(Ptr<const Packet> p) {
+    SenderTx(p);
+    g_summary.echoSent[p->GetUid()] = Simulator::Now();
+}
+
+
+static void EchoClientRx(Ptr<const Packet> p) {
+    auto it = g_summary.echoSent.find(p->GetUid());
+    if (it != g_summary.echoSent.end()) {
+        g_summary.rttSamples++;
+        g_summary.rttSum += (Simulator::Now() - it->second).GetSeconds();
+        g_summary.echoSent.erase(it);
+    }
+}
+
+
+static void EchoServerRx(Ptr<const Packet> p) {
+    g_summary.rxPackets++;
+    g_summary.rxBytes += p->GetSize();
+    g_summary.lastRx = Simulator::Now().GetSeconds();
+}
+
+
+static void SinkRx(Ptr<const Packet> p, const Address & from) {
+    g_summary.rxPackets++;
+    g_summary.rxBytes += p->GetSize();
+    g_summary.lastRx = Simulator::Now().GetSeconds();
+}
+
+
+static void TcpRtt(Time oldRtt, Time newRtt) {
+    g_summary.rttSamples++;
+    g_summary.rttSum += newRtt.GetSeconds();
+}
+
+
+static void TcpSocketTx(uint32_t sender, Ptr<const Packet> p, const TcpHeader & header, Ptr<const TcpSocketBase> socket) {
+    if (p->GetSize() == 0) {
+        return;
+    }
+    g_summary.tcpSegments++;
+    if (IsRetransmission(g_summary.tcpSenders[sender], header.GetSequenceNumber().GetValue(), p->GetSize())) {
+        g_summary.tcpRetransmissions++;
+    }
+}
+
+
+/* the OnOff socket only exists once the application has started */
+static void ConnectTcpSocket(Ptr<Application> senderApp, uint32_t sender) {
+    Ptr<Socket> socket = DynamicCast<OnOffApplication>(senderApp)->GetSocket();
+    if (socket) {
+        socket->TraceConnectWithoutContext("RTT", MakeCallback(&TcpRtt));
+        socket->TraceConnectWithoutContext("Tx", MakeBoundCallback(&TcpSocketTx, sender));
+    }
+}
+
+
+/* applications of this rank only, see ReduceSummary() */
+void InstallSummary(const ScenarioConfig & config, Topology & topology) {
+    bool tcp = config.transport == "tcp";
+    bool load = !tcp && config.udpApp == "load";
+    g_summary.tcpSenders.resize(topology.senderApps.GetN());
+    for (uint32_t i = 0; i < topology.senderApps.GetN(); ++i) {
+        Ptr<Application> senderApp = topology.senderApps.Get(i);
+        if (tcp) {
+            senderApp->TraceConnectWithoutContext("Tx", MakeCallback(&SenderTx));
+            Simulator::Schedule(Seconds(2.0) + NanoSeconds(1), &ConnectTcpSocket, senderApp, i);
+        }
+        else if (load) {
+            senderApp->TraceConnectWithoutContext("Tx", MakeCallback(&SenderTx));
+        }
+        else {
+            senderApp->TraceConnectWithoutContext("Tx", MakeCallback(&EchoClientTx));
+            senderApp->TraceConnectWithoutContext("Rx", MakeCallback(&EchoClientRx));
+        }
+    }
+    if (topology.receiverApps.GetN() > 0) {
+        Ptr<Application> receiverApp = topology.receiverApps.Get(0);
+        // the udp load sink traces the PacketSink's signature
+        if (tcp || load) {
+            receiverApp->TraceConnectWithoutContext("Rx", MakeCallback(&SinkRx));
+        }
+        else {
+            receiverApp->TraceConnectWithoutContext("Rx", MakeCallback(&EchoServerRx));
+        }
+    }
+}
+
+
+/* --distributed: every rank counted its own applications and drop sites,
+   sum them so that every rank holds the totals of the sequential run */
+void ReduceSummary(const ScenarioConfig & config, DropStats & dropStats, RunStats & runStats) {
+#ifdef NS3_MPI
+    if (!config.distributed) {
+        return;
+    }
+    uint64_t counters[] = { g_summary.txPackets, g_summary.txBytes, g_summary.rxPackets, g_summary.rxBytes, g_summary.rttSamples, runStats.events,
+                            g_summary.tcpSegments, g_summary.tcpRetransmissions };
+    MPI_Allreduce(MPI_IN_PLACE, counters, 8, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+    // every rank holds every node, the largest rank's memory is the figure per node
+    MPI_Allreduce(MPI_IN_PLACE, &runStats.setupBytes, 1, MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+    g_summary.txPackets = counters[0];
+    g_summary.txBytes = counters[1];
+    g_summary.rxPackets = counters[2];
+    g_summary.rxBytes = counters[3];
+    g_summary.rttSamples = counters[4];
+    runStats.events = counters[5];
+    g_summary.tcpSegments = counters[6];
+    g_summary.tcpRetransmissions = counters[7];
+    MPI_Allreduce(MPI_IN_PLACE, &g_summary.lastRx, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    // only the sender rank has RTT samples, adding zeros keeps the sum exact
+    MPI_Allreduce(MPI_IN_PLACE, &g_summary.rttSum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &runStats.wallSeconds, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    dropStats.Reduce();
+#endif
+}
+
+
+/* values derived from the counters, shared by the csv and the printed summary */
+struct SummaryValues {
+    double throughput;
+    uint64_t receiverDrops;
+    uint64_t interDrops;
+    double lossRate;
+    double meanRtt;
+    double eventsPerSecond;
+    double bytesPerNode;
+    double retransmissionRatio;
+    double completionSeconds;       // from the sender start to the last receive
+    double goodput;                 // bits per second over completionSeconds
+};
+
+
+static SummaryValues ComputeSummary(const ScenarioConfig & config, const DropStats & dropStats, const RunStats & runStats) {
+    SummaryValues v;
+    double appSeconds = config.seconds - 2.0;
+    v.throughput = appSeconds > 0 ? g_summary.rxBytes * 8.0 / appSeconds : 0.0;
+    v.receiverDrops = dropStats.GetDrops(RECEIVER_DROP);
+    v.interDrops = dropStats.GetDrops(INTER_DROP);
+    uint64_t arrivals = dropStats.GetArrivals();
+    v.lossRate = arrivals > 0 ? double(v.receiverDrops + v.interDrops) / arrivals : 0.0;
+    v.meanRtt = g_summary.rttSamples > 0 ? g_summary.rttSum / g_summary.rttSamples : 0.0;
+    v.eventsPerSecond = runStats.wallSeconds > 0 ? runStats.events / runStats.wallSeconds : 0.0;
+    v.bytesPerNode = runStats.nodes > 0 ? double(runStats.setupBytes) / runStats.nodes : 0.0;
+    v.retransmissionRatio = g_summary.tcpSegments > 0 ? double(g_summary.tcpRetransmissions) / g_summary.tcpSegments : 0.0;
+    v.completionSeconds = g_summary.rxPackets > 0 ? g_summary.lastRx - 2.0 : 0.0;
+    v.goodput = v.completionSeconds > 0 ? g_summary.rxBytes * 8.0 / v.completionSeconds : 0.0;
+    return v;
+}
+
+
+void WriteSummary(const ScenarioConfig & config, const DropStats & dropStats, const RunStats & runStats, const std::string & path) {
+    SummaryValues v = ComputeSummary(config, dropStats, runStats);
+
+    std::ofstream out(path.c_str());
+    if (!out) {
+        NS_FATAL_ERROR("Cannot open summary file " << path);
+    }
+    out << "scenario,txPackets,txBytes,rxPackets,rxBytes,throughputBps,receiverDrops,interDrops,lossRate,meanRttSeconds,"
+        << "events,wallSeconds,eventsPerSecond,nodes,setupBytes,bytesPerNode,"
+        << "tcpSegments,tcpRetransmissions,retransmissionRatio,completionSeconds,goodputBps\n";
+    out << ScenarioName(config) << ","
+        << g_summary.txPackets << "," << g_summary.txBytes << ","
+        << g_summary.rxPackets << "," << g_summary.rxBytes << ","
+        << v.throughput << ","
+        << v.receiverDrops << "," << v.interDrops << ","
+        << v.lossRate << "," << v.meanRtt << ","
+        << runStats.events << "," << runStats.wallSeconds << "," << v.eventsPerSecond << ","
+        << runStats.nodes << "," << runStats.setupBytes << "," << v.bytesPerNode << ","
+        << g_summary.tcpSegments << "," << g_summary.tcpRetransmissions << "," << v.retransmissionRatio << ","
+        << v.completionSeconds << "," << v.goodput << "\n";
+}
+
+
+/* --verbose=stats: the same counters, one per line on stdout */
+void PrintSummary(const ScenarioConfig & config, const DropStats & dropStats, const RunStats & runStats) {
+    SummaryValues v = ComputeSummary(config, dropStats, runStats);
+
+    std::cout << std::left
+              << std::setw(20) << "scenario" << ScenarioName(config) << "\n"
+              << std::setw(20) << "txPackets" << g_summary.txPackets << "\n"
+              << std::setw(20) << "txBytes" << g_summary.txBytes << "\n"
+              << std::setw(20) << "rxPackets" << g_summary.rxPackets << "\n"
+              << std::setw(20) << "rxBytes" << g_summary.rxBytes << "\n"
+              << std::setw(20) << "throughputBps" << v.throughput << "\n"
+              << std::setw(20) << "receiverDrops" << v.receiverDrops << "\n"
+              << std::setw(20) << "interDrops" << v.interDrops << "\n"
+              << std::setw(20) << "lossRate" << v.lossRate << "\n"
+              << std::setw(20) << "meanRttSeconds" << v.meanRtt << "\n"
+              << std::setw(20) << "events" << runStats.events << "\n"
+              << std::setw(20) << "wallSeconds" << runStats.wallSeconds << "\n"
+              << std::setw(20) << "eventsPerSecond" << v.eventsPerSecond << "\n"
+              << std::setw(20) << "nodes" << runStats.nodes << "\n"
+              << std::setw(20) << "setupBytes" << runStats.setupBytes << "\n"
+              << std::setw(20) << "bytesPerNode" << v.bytesPerNode << "\n"
+              << std::setw(20) << "tcpSegments" << g_summary.tcpSegments << "\n"
+              << std::setw(20) << "tcpRetransmissions" << g_summary.tcpRetransmissions << "\n"
+              << std::setw(20) << "retransmissionRatio" << v.retransmissionRatio << "\n"
+              << std::setw(20) << "completionSeconds" << v.completionSeconds << "\n"
+              << std::setw(20) << "goodputBps" << v.goodput << "\n";
+}
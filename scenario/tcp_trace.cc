@@ -0,0 +1,210 @@
+#include <cstdio>
+#include <vector>
+#include "scenario.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+// One binary file per traced value, <prefix>_<column>.bin:
+//
+//   char     magic[8]      "TCPTRC01"
+//   uint64_t records
+//   records in time order, 16 bytes each, little endian:
+//     int64_t  nanoseconds
+//     uint32_t sender      index of the OnOff application, in --senderShare order
+//     uint32_t value       cwnd: bytes, rtt: microseconds, inflight: bytes,
+//                          retx: sequence number of the retransmitted segment
+
+
+struct TcpTraceRecord {
+    int64_t nanoseconds;
+    uint32_t sender;
+    uint32_t value;
+};
+
+
+enum TcpTraceColumn {
+    TCP_CWND,
+    TCP_RTT,
+    TCP_INFLIGHT,
+    TCP_RETX,
+    TCP_COLUMNS
+};
+
+static const char * TCP_COLUMN_NAMES[TCP_COLUMNS] = { "cwnd", "rtt", "inflight", "retx" };
+
+
+/* a downsampled value of one sender: the latest change not yet written */
+struct TcpTraceValue {
+    int64_t last = -1;              // time of the latest record, ns
+    bool pending = false;
+    uint32_t value = 0;
+    EventId flush;
+};
+
+
+/* per sender state of the traced socket */
+struct TcpTraceSender {
+    TcpTraceValue values[TCP_COLUMNS];
+    TcpSendState send;
+};
+
+
+/* tcp trace state, one instance per process */
+static struct {
+    std::FILE * files[TCP_COLUMNS] = {};
+    uint64_t counts[TCP_COLUMNS] = {};
+    std::vector<TcpTraceRecord> buffers[TCP_COLUMNS];
+    std::vector<TcpTraceSender> senders;
+    int64_t interval = 0;           // ns between two records of a column and sender, 0: every change
+} g_tcpTrace;
+
+
+static void FlushColumn(int column) {
+    std::vector<TcpTraceRecord> & buffer = g_tcpTrace.buffers[column];
+    std::fwrite(buffer.data(), sizeof(TcpTraceRecord), buffer.size(), g_tcpTrace.files[column]);
+    g_tcpTrace.counts[column] += buffer.size();
+    buffer.clear();
+}
+
+
+static void Append(int column, uint32_t sender, uint32_t value) {
+    std::vector<TcpTraceRecord> & buffer = g_tcpTrace.buffers[column];
+    buffer.push_back(TcpTraceRecord{ Simulator::Now().GetNanoSeconds(), sender, value });
+    if (buffer.size() == buffer.capacity()) {
+        FlushColumn(column);
+    }
+}
+
+
+/* interval after a record: the latest value held since, stamped now */
+static void FlushValue(int column, uint32_t sender) {
+    TcpTraceValue & v = g_tcpTrace.senders[sender].values[column];
+    if (v.pending) {
+        Append(column, sender, v.value);
+        v.last = Simulator::Now().GetNanoSeconds();
+        v.pending = false;
+    }
+}
+
+
+/* the retransmission column is never downsampled; every other one is
+   sample and hold: a change within interval of the latest record is kept
+   and written, if nothing newer replaced it, when interval has passed */
+static void Record(int column, uint32_t sender, uint32_t value) {
+    if (column == TCP_RETX || g_tcpTrace.interval == 0) {
+        Append(column, sender, value);
+        return;
+    }
+    int64_t now = Simulator::Now().GetNanoSeconds();
+    TcpTraceValue & v = g_tcpTrace.senders[sender].values[column];
+    if (v.last < 0 || now - v.last >= g_tcpTrace.interval) {
+        // a flush due at this very time would write the older value
+        Simulator::Cancel(v.flush);
+        Append(column, sender, value);
+        v.last = now;
+        v.pending = false;
+        return;
+    }
+    v.value = value;
+    if (!v.pending) {
+        v.pending = true;
+        v.flush = Simulator::Schedule(NanoSeconds(v.last + g_tcpTrace.interval - now), &FlushValue, column, sender);
+    }
+}
+
+
+static void CwndChange(uint32_t sender, uint32_t oldValue, uint32_t newValue) {
+    Record(TCP_CWND, sender, newValue);
+}
+
+
+static void RttChange(uint32_t sender, Time oldValue, Time newValue) {
+    Record(TCP_RTT, sender, uint32_t(newValue.GetMicroSeconds()));
+}
+
+
+static void InflightChange(uint32_t sender, uint32_t oldValue, uint32_t newValue) {
+    Record(TCP_INFLIGHT, sender, newValue);
+}
+
+
+/* ns-3.32's TcpSocketBase has no retransmission trace source: a data
+   segment that ends at or below the highest one sent is sent again */
+bool IsRetransmission(TcpSendState & state, uint32_t seq, uint32_t size) {
+    uint32_t end = seq + size;
+    // sequence numbers wrap, compare their distance
+    if (state.sent && int32_t(end - state.highestSent) <= 0) {
+        return true;
+    }
+    state.highestSent = end;
+    state.sent = true;
+    return false;
+}
+
+
+static void SocketTx(uint32_t sender, Ptr<const Packet> p, const TcpHeader & header, Ptr<const TcpSocketBase> socket) {
+    uint32_t seq = header.GetSequenceNumber().GetValue();
+    if (p->GetSize() > 0 && IsRetransmission(g_tcpTrace.senders[sender].send, seq, p->GetSize())) {
+        Record(TCP_RETX, sender, seq);
+    }
+}
+
+
+/* the OnOff socket only exists once the application has started */
+static void ConnectSocket(Ptr<Application> senderApp, uint32_t sender) {
+    Ptr<Socket> socket = DynamicCast<OnOffApplication>(senderApp)->GetSocket();
+    if (!socket) {
+        return;
+    }
+    socket->TraceConnectWithoutContext("CongestionWindow", MakeBoundCallback(&CwndChange, sender));
+    socket->TraceConnectWithoutContext("RTT", MakeBoundCallback(&RttChange, sender));
+    socket->TraceConnectWithoutContext("BytesInFlight", MakeBoundCallback(&InflightChange, sender));
+    socket->TraceConnectWithoutContext("Tx", MakeBoundCallback(&SocketTx, sender));
+}
+
+
+/* senders of this rank only, the receiver rank writes nothing */
+void InstallTcpTrace(const ScenarioConfig & config, Topology & topology) {
+    if (topology.senderApps.GetN() == 0) {
+        return;
+    }
+    for (int column = 0; column < TCP_COLUMNS; ++column) {
+        std::string path = OutputPrefix(config) + "_" + TCP_COLUMN_NAMES[column] + ".bin";
+        g_tcpTrace.files[column] = std::fopen(path.c_str(), "wb");
+        if (!g_tcpTrace.files[column]) {
+            NS_FATAL_ERROR("Cannot open tcp trace file " << path);
+        }
+        // the record count is written at the end of the run
+        uint64_t count = 0;
+        std::fwrite("TCPTRC01", 1, 8, g_tcpTrace.files[column]);
+        std::fwrite(&count, sizeof(count), 1, g_tcpTrace.files[column]);
+        g_tcpTrace.buffers[column].reserve(4096);
+    }
+    g_tcpTrace.interval = Seconds(config.tcpTraceInterval).GetNanoSeconds();
+
+    g_tcpTrace.senders.assign(topology.senderApps.GetN(), TcpTraceSender());
+    for (uint32_t i = 0; i < topology.senderApps.GetN(); ++i) {
+        Simulator::Schedule(Seconds(2.0) + NanoSeconds(1), &ConnectSocket, topology.senderApps.Get(i), i);
+    }
+}
+
+
+/* after the run: the values still held are written at the stop time */
+void CloseTcpTrace(void) {
+    for (uint32_t sender = 0; sender < g_tcpTrace.senders.size(); ++sender) {
+        for (int column = 0; column < TCP_COLUMNS; ++column) {
+            FlushValue(column, sender);
+        }
+    }
+    for (int column = 0; column < TCP_COLUMNS; ++column) {
+        if (!g_tcpTrace.files[column]) {
+            continue;
+        }
+        FlushColumn(column);
+        std::fseek(g_tcpTrace.files[column], 8, SEEK_SET);
+        std::fwrite(&g_tcpTrace.counts[column], sizeof(uint64_t), 1, g_tcpTrace.files[column]);
+        std::fclose(g_tcpTrace.files[column]);
+        g_tcpTrace.files[column] = nullptr;
+    }
+}
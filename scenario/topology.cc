@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cmath>
+#include "scenario.h"
+#include "range_wifi_channel.h"
+#include "batched_mobility.h"
+#include "ns3/wifi-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/ssid.h"
+#include "ns3/ipv4-global-routing-helper.h"
+
+using namespace ns3;
+
+
+/* csma access network: node0 followed by number new nodes */
+static NetDeviceContainer BuildCsma(const ScenarioConfig & config, CsmaHelper & csma, Ptr<Node> node0, NodeContainer & nodes) {
+    nodes.Add(node0);
+    nodes.Create(config.csmaNumber, node0->GetSystemId());
+    csma.SetChannelAttribute("DataRate", DataRateValue(DataRate(config.csmaDataRate)));
+    csma.SetChannelAttribute("Delay", TimeValue(NanoSeconds(config.csmaDelay)));
+    return csma.Install(nodes);
+}
+
+
+/* wifi access network: AP on apNode, wifiNumber random walk stations */
+static void BuildWifiSender(const ScenarioConfig & config, Topology & topology, Ptr<Node> apNode) {
+    if (config.wifiRange > 0) {
+        // the models of YansWifiChannelHelper::Default(), only stations within wifiRange receive
+        Ptr<RangeYansWifiChannel> channel = CreateObjectWithAttributes<RangeYansWifiChannel>("Range", DoubleValue(config.wifiRange));
+        if (config.mobility == "batched") {
+            channel->SetAttribute("PositionTick", TimeValue(Seconds(config.mobilityTick)));
+        }
+        channel->SetPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+        channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+        topology.wifiSenderPhy = RangeYansWifiPhyHelper();
+        topology.wifiSenderPhy.SetChannel(channel);
+    }
+    else {
+        YansWifiChannelHelper wifiSenderChannel = YansWifiChannelHelper::Default();
+        topology.wifiSenderPhy = YansWifiPhyHelper::Default();
+        topology.wifiSenderPhy.SetChannel(wifiSenderChannel.Create());
+    }
+    WifiHelper wifiSender;
+    wifiSender.SetRemoteStationManager("ns3::AarfWifiManager");
+    WifiMacHelper wifiSenderMac;
+    Ssid wifiSenderSsid = Ssid("ns-3-ssid");
+
+    topology.wifiSenderStaNodes.Create(config.wifiNumber, SenderRank(config));
+    wifiSenderMac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(wifiSenderSsid), "ActiveProbing", BooleanValue(false));
+    NetDeviceContainer wifiSenderStaDevices = wifiSender.Install(topology.wifiSenderPhy, wifiSenderMac, topology.wifiSenderStaNodes);
+
+    NodeContainer wifiSenderApNode = apNode;
+    wifiSenderMac.SetType("ns3::ApWifiMac", "Ssid", SsidValue(wifiSenderSsid));
+    NetDeviceContainer wifiSenderApDevice = wifiSender.Install(topology.wifiSenderPhy, wifiSenderMac, wifiSenderApNode);
+
+    // a square grid, 3 stations per row at least as in the original scenarios,
+    // and their random walk area -50..50 m, which leaves 40 m beyond the
+    // 3 station grid; only a larger grid grows it, by keeping those 40 m
+    uint32_t gridWidth = std::max(3u, uint32_t(std::ceil(std::sqrt(double(config.wifiNumber)))));
+    uint32_t gridRows = (config.wifiNumber + gridWidth - 1) / gridWidth;
+    double deltaX = 5.0;
+    double deltaY = 10.0;
+    double maxX = std::max(50.0, deltaX * (gridWidth - 1) + 40.0);
+    double maxY = std::max(50.0, deltaY * (gridRows - 1) + 40.0);
+    MobilityHelper senderMobility;
+    senderMobility.SetPositionAllocator("ns3::GridPositionAllocator", "MinX", DoubleValue(0.0), "MinY", DoubleValue(0.0), "DeltaX", DoubleValue(deltaX), "DeltaY", DoubleValue(deltaY), "GridWidth", UintegerValue(gridWidth), "LayoutType", EnumValue(GridPositionAllocator::ROW_FIRST));
+    Rectangle bounds(-50, maxX, -50, maxY);
+    if (config.mobility == "batched") {
+        Ptr<BatchedMobilityBlock> block = CreateObjectWithAttributes<BatchedMobilityBlock>("Bounds", RectangleValue(bounds), "Tick", TimeValue(Seconds(config.mobilityTick)));
+        senderMobility.SetMobilityModel("BatchedRandomWalk2dMobilityModel", "Block", PointerValue(block));
+    }
+    else {
+        senderMobility.SetMobilityModel("ns3::RandomWalk2dMobilityModel", "Bounds", RectangleValue(bounds));
+    }
+    senderMobility.Install(topology.wifiSenderStaNodes);
+    senderMobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    senderMobility.Install(wifiSenderApNode);
+
+    // stations are addressed before the AP, as in the original wifi scenarios
+    topology.senderNodes.Add(apNode);
+    topology.senderNodes.Add(topology.wifiSenderStaNodes);
+    topology.senderDevices.Add(wifiSenderStaDevices);
+    topology.senderDevices.Add(wifiSenderApDevice);
+}
+
+
+/* senderShare of the access nodes send: senderNode first, the others spread evenly over the rest */
+static void SelectActiveSenders(const ScenarioConfig & config, Topology & topology) {
+    topology.activeSenderNodes.Add(topology.senderNode);
+    NodeContainer others;
+    if (config.sender == "csma") {
+        for (uint32_t i = 1; i < config.csmaNumber; ++i) {
+            others.Add(topology.senderNodes.Get(i));
+        }
+    }
+    else if (config.sender == "wifi") {
+        for (uint32_t i = 0; i + 1 < config.wifiNumber; ++i) {
+            others.Add(topology.wifiSenderStaNodes.Get(i));
+        }
+    }
+    uint32_t senders = std::max(1u, uint32_t(std::lround(config.senderShare * (others.GetN() + 1))));
+    uint32_t count = std::min(others.GetN(), senders - 1);
+    for (uint32_t i = 0; i < count; ++i) {
+        topology.activeSenderNodes.Add(others.Get(uint64_t(i) * others.GetN() / count));
+    }
+}
+
+
+void BuildTopology(const ScenarioConfig & config, Topology & topology) {
+    // p2p
+    // n0 and n1, on the sender and the receiver rank
+    topology.p2pNodes.Create(1, SenderRank(config));
+    topology.p2pNodes.Create(1, ReceiverRank(config));
+    topology.p2p.SetDeviceAttribute("DataRate", DataRateValue(DataRate(config.p2pDataRate)));
+    topology.p2p.SetChannelAttribute("Delay", TimeValue(Time(config.p2pDelay)));
+    topology.p2pDevices = topology.p2p.Install(topology.p2pNodes);
+
+    // sender
+    if (config.sender == "csma") {
+        topology.senderDevices = BuildCsma(config, topology.csmaSender, topology.p2pNodes.Get(0), topology.senderNodes);
+        topology.senderNode = topology.senderNodes.Get(config.csmaNumber);
+        topology.senderDevice = topology.senderDevices.Get(config.csmaNumber);
+    }
+    else if (config.sender == "wifi") {
+        BuildWifiSender(config, topology, topology.p2pNodes.Get(0));
+        topology.senderNode = topology.wifiSenderStaNodes.Get(config.wifiNumber - 1);
+        topology.senderDevice = topology.senderDevices.Get(config.wifiNumber - 1);
+    }
+    else {
+        topology.senderNodes.Add(topology.p2pNodes.Get(0));
+        topology.senderNode = topology.p2pNodes.Get(0);
+        topology.senderDevice = topology.p2pDevices.Get(0);
+    }
+
+    SelectActiveSenders(config, topology);
+
+    // receiver
+    if (config.receiver == "csma") {
+        topology.receiverDevices = BuildCsma(config, topology.csmaReceiver, topology.p2pNodes.Get(1), topology.receiverNodes);
+        topology.receiverNode = topology.receiverNodes.Get(config.csmaNumber);
+        topology.receiverDevice = topology.receiverDevices.Get(config.csmaNumber);
+    }
+    else {
+        topology.receiverNodes.Add(topology.p2pNodes.Get(1));
+        topology.receiverNode = topology.p2pNodes.Get(1);
+        topology.receiverDevice = topology.p2pDevices.Get(1);
+    }
+
+    // inter: only when an access network puts the p2p link in the middle of the path
+    if (config.sender != "none" || config.receiver != "none") {
+        for (uint32_t i = 0; i < topology.p2pDevices.GetN(); ++i) {
+            if (topology.p2pDevices.Get(i) != topology.receiverDevice) {
+                topology.interDevices.Add(topology.p2pDevices.Get(i));
+            }
+        }
+    }
+}
+
+
+void InstallInternetStack(const ScenarioConfig & config, Topology & topology) {
+    // every TcpL4Protocol takes its congestion control from the default
+    Config::SetDefault("ns3::TcpL4Protocol::SocketType", TypeIdValue(TypeId::LookupByName("ns3::Tcp" + config.tcpVariant)));
+    InternetStackHelper stack;
+    stack.Install(topology.senderNodes);
+    stack.Install(topology.receiverNodes);
+
+    Ipv4AddressHelper address;
+    address.SetBase("10.1.1.0", "255.255.255.0");
+    topology.p2pInterfaces = address.Assign(topology.p2pDevices);
+    if (config.sender != "none") {
+        address.SetBase("10.1.2.0", "255.255.255.0");
+        address.Assign(topology.senderDevices);
+    }
+    if (config.receiver != "none") {
+        address.SetBase("10.1.3.0", "255.255.255.0");
+        Ipv4InterfaceContainer receiverInterfaces = address.Assign(topology.receiverDevices);
+        topology.receiverAddress = receiverInterfaces.GetAddress(config.csmaNumber);
+    }
+    else {
+        topology.receiverAddress = topology.p2pInterfaces.GetAddress(1);
+    }
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+}
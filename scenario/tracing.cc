@@ -0,0 +1,162 @@
+#include <fstream>
+#include "scenario.h"
+#include "drop_stats.h"
+#include "async_pcap.h"
+#include "ns3/wifi-module.h"
+
+using namespace ns3;
+
+
+/* async writers still open, closed by CloseTracing() */
+static std::vector<Ptr<AsyncPcapWriter> > g_asyncWriters;
+
+
+/* loss callback */
+static void RxDrop(Ptr<PcapFileWrapper> file, Ptr<const Packet> p) {
+    file->Write(Simulator::Now(), p);
+}
+
+
+/* loss callback, async writer */
+static void RxDropAsync(Ptr<AsyncPcapWriter> writer, Ptr<const Packet> p) {
+    writer->Write(Simulator::Now(), p);
+}
+
+
+/* loss callback print, only connected with --dropLog; the site is a template
+   parameter so nothing is compared per drop */
+template <DropSite site>
+static void RxDropPrint(Ptr<const Packet> p) {
+    NS_LOG_UNCOND((site == RECEIVER_DROP ? "ReceiverRxDrop at " : "InterRxDrop at ") << Simulator::Now().GetSeconds());
+}
+
+
+/* p2p and csma promiscuous sniffer, async writer */
+static void SniffAsync(Ptr<AsyncPcapWriter> writer, Ptr<const Packet> p) {
+    writer->Write(Simulator::Now(), p);
+}
+
+
+/* wifi monitor sniffers, async writer; DLT_IEEE802_11 records carry the packet as is */
+static void SniffWifiTxAsync(Ptr<AsyncPcapWriter> writer, Ptr<const Packet> p, uint16_t channelFreqMhz, WifiTxVector txVector, MpduInfo aMpdu) {
+    writer->Write(Simulator::Now(), p);
+}
+
+
+static void SniffWifiRxAsync(Ptr<AsyncPcapWriter> writer, Ptr<const Packet> p, uint16_t channelFreqMhz, WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise) {
+    writer->Write(Simulator::Now(), p);
+}
+
+
+static Ptr<AsyncPcapWriter> CreateAsyncWriter(const std::string & path, uint32_t dataLinkType, uint32_t snapLen, uint32_t sample) {
+    Ptr<AsyncPcapWriter> writer = Create<AsyncPcapWriter>(path, dataLinkType, snapLen, sample);
+    g_asyncWriters.push_back(writer);
+    return writer;
+}
+
+
+/* promiscuous pcap of device, <prefix>-<node>-<device>.pcap as the ns-3 helpers name it */
+static void EnablePcapOn(const ScenarioConfig & config, Topology & topology, const std::string & prefix, Ptr<NetDevice> device) {
+    if (!IsLocal(device->GetNode())) {
+        return;     // written by the rank that owns the device
+    }
+    Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice>(device);
+    Ptr<CsmaNetDevice> csmaDevice = DynamicCast<CsmaNetDevice>(device);
+
+    if (config.pcapWriter != "async") {
+        if (wifiDevice) {
+            topology.wifiSenderPhy.EnablePcap(prefix, device, true);
+        }
+        else if (csmaDevice) {
+            topology.csmaSender.EnablePcap(prefix, device, true);
+        }
+        else {
+            topology.p2p.EnablePcap(prefix, device, true);
+        }
+        return;
+    }
+
+    PcapHelper pcapHelper;
+    std::string path = pcapHelper.GetFilenameFromDevice(prefix, device);
+    if (wifiDevice) {
+        Ptr<AsyncPcapWriter> writer = CreateAsyncWriter(path, PcapHelper::DLT_IEEE802_11, config.pcapSnapLen, config.pcapSample);
+        wifiDevice->GetPhy()->TraceConnectWithoutContext("MonitorSnifferTx", MakeBoundCallback(&SniffWifiTxAsync, writer));
+        wifiDevice->GetPhy()->TraceConnectWithoutContext("MonitorSnifferRx", MakeBoundCallback(&SniffWifiRxAsync, writer));
+    }
+    else {
+        Ptr<AsyncPcapWriter> writer = CreateAsyncWriter(path, csmaDevice ? PcapHelper::DLT_EN10MB : PcapHelper::DLT_PPP, config.pcapSnapLen, config.pcapSample);
+        device->TraceConnectWithoutContext("PromiscSniffer", MakeBoundCallback(&SniffAsync, writer));
+    }
+}
+
+
+/* udp: ascii traces of every segment, pcap on both endpoints */
+static void EnableUdpCaptures(const ScenarioConfig & config, Topology & topology, const std::string & prefix) {
+    AsciiTraceHelper ascii;
+    std::string rank = RankSuffix(config);
+    topology.p2p.EnableAsciiAll(ascii.CreateFileStream(prefix + rank + "_p2p.tr"));
+    if (config.sender == "csma" && Rank() == SenderRank(config)) {
+        topology.csmaSender.EnableAsciiAll(ascii.CreateFileStream(prefix + "_csmaSender.tr"));
+    }
+    else if (config.sender == "wifi" && Rank() == SenderRank(config)) {
+        topology.wifiSenderPhy.EnableAsciiAll(ascii.CreateFileStream(prefix + "_wifiSender.tr"));
+    }
+    if (config.receiver == "csma" && Rank() == ReceiverRank(config)) {
+        topology.csmaReceiver.EnableAsciiAll(ascii.CreateFileStream(prefix + "_csmaReceiver.tr"));
+    }
+
+    EnablePcapOn(config, topology, prefix, topology.senderDevice);
+    EnablePcapOn(config, topology, prefix, topology.receiverDevice);
+}
+
+
+/* tcp: pcap on the sender only, read back with tcpdump */
+static void EnableTcpCaptures(const ScenarioConfig & config, Topology & topology, const std::string & prefix) {
+    EnablePcapOn(config, topology, prefix, topology.senderDevice);
+}
+
+
+void EnableTracing(const ScenarioConfig & config, Topology & topology) {
+    std::string prefix = OutputPrefix(config);
+
+    if (config.tracing) {
+        if (config.transport == "tcp") {
+            EnableTcpCaptures(config, topology, prefix);
+        }
+        else {
+            EnableUdpCaptures(config, topology, prefix);
+        }
+
+        if (config.pcapWriter == "async") {
+            // drops are rare, the drop pcap is never sampled
+            Ptr<AsyncPcapWriter> writer = CreateAsyncWriter(prefix + RankSuffix(config) + "_drop.pcap", PcapHelper::DLT_PPP, config.pcapSnapLen, 1);
+            topology.receiverDevice->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&RxDropAsync, writer));
+            for (uint32_t i = 0; i < topology.interDevices.GetN(); ++i) {
+                topology.interDevices.Get(i)->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&RxDropAsync, writer));
+            }
+        }
+        else {
+            PcapHelper pcapHelper;
+            Ptr<PcapFileWrapper> file = pcapHelper.CreateFile(prefix + RankSuffix(config) + "_drop.pcap", std::ios::out, PcapHelper::DLT_PPP);
+            topology.receiverDevice->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&RxDrop, file));
+            for (uint32_t i = 0; i < topology.interDevices.GetN(); ++i) {
+                topology.interDevices.Get(i)->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&RxDrop, file));
+            }
+        }
+    }
+
+    if (config.dropLog) {
+        topology.receiverDevice->TraceConnectWithoutContext("PhyRxDrop", MakeCallback(&RxDropPrint<RECEIVER_DROP>));
+        for (uint32_t i = 0; i < topology.interDevices.GetN(); ++i) {
+            topology.interDevices.Get(i)->TraceConnectWithoutContext("PhyRxDrop", MakeCallback(&RxDropPrint<INTER_DROP>));
+        }
+    }
+}
+
+
+void CloseTracing(void) {
+    for (Ptr<AsyncPcapWriter> writer : g_asyncWriters) {
+        writer->Close();
+    }
+    g_asyncWriters.clear();
+}
@@ -0,0 +1,222 @@
+#include "udp_load.h"
+#include "ns3/address-utils.h"
+#include "ns3/enum.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/packet.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+NS_OBJECT_ENSURE_REGISTERED(UdpLoadGenerator);
+NS_OBJECT_ENSURE_REGISTERED(UdpLoadSink);
+
+
+TypeId UdpLoadGenerator::GetTypeId(void) {
+    static TypeId tid = TypeId("UdpLoadGenerator")
+        .SetParent<Application>()
+        .AddConstructor<UdpLoadGenerator>()
+        .AddAttribute("Remote", "Address of the UdpLoadSink",
+                      AddressValue(),
+                      MakeAddressAccessor(&UdpLoadGenerator::m_remote),
+                      MakeAddressChecker())
+        .AddAttribute("PacketSize", "UDP payload bytes, SeqTsHeader included",
+                      UintegerValue(1024),
+                      MakeUintegerAccessor(&UdpLoadGenerator::m_packetSize),
+                      MakeUintegerChecker<uint32_t>(12))
+        .AddAttribute("DataRate", "Mean rate of the UDP payload",
+                      DataRateValue(DataRate("1Mbps")),
+                      MakeDataRateAccessor(&UdpLoadGenerator::m_dataRate),
+                      MakeDataRateChecker())
+        .AddAttribute("Mode", "Gaps between packets",
+                      EnumValue(MODE_CBR),
+                      MakeEnumAccessor(&UdpLoadGenerator::m_mode),
+                      MakeEnumChecker(MODE_CBR, "cbr", MODE_POISSON, "poisson", MODE_BURST, "burst"))
+        .AddAttribute("BurstPackets", "Packets sent back to back (burst)",
+                      UintegerValue(10),
+                      MakeUintegerAccessor(&UdpLoadGenerator::m_burstPackets),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddTraceSource("Tx", "A packet is sent",
+                        MakeTraceSourceAccessor(&UdpLoadGenerator::m_txTrace),
+                        "ns3::Packet::TracedCallback");
+    return tid;
+}
+
+
+UdpLoadGenerator::UdpLoadGenerator()
+    : m_packetSize(1024),
+      m_mode(MODE_CBR),
+      m_burstPackets(10),
+      m_gap(CreateObject<ExponentialRandomVariable>()),
+      m_seq(0) {
+}
+
+
+UdpLoadGenerator::~UdpLoadGenerator() {
+}
+
+
+int64_t UdpLoadGenerator::AssignStreams(int64_t stream) {
+    m_gap->SetStream(stream);
+    return 1;
+}
+
+
+void UdpLoadGenerator::DoDispose(void) {
+    m_socket = 0;
+    m_payload = 0;
+    Application::DoDispose();
+}
+
+
+void UdpLoadGenerator::StartApplication(void) {
+    if (m_dataRate.GetBitRate() == 0) {
+        NS_FATAL_ERROR("UdpLoadGenerator DataRate must be positive");
+    }
+    if (!m_socket) {
+        m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+        m_socket->Bind();
+        m_socket->Connect(m_remote);
+    }
+    m_payload = Create<Packet>(m_packetSize - SeqTsHeader().GetSerializedSize());
+    m_sendEvent = Simulator::ScheduleNow(&UdpLoadGenerator::Send, this);
+}
+
+
+void UdpLoadGenerator::StopApplication(void) {
+    Simulator::Cancel(m_sendEvent);
+}
+
+
+void UdpLoadGenerator::Send(void) {
+    uint32_t packets = m_mode == MODE_BURST ? m_burstPackets : 1;
+    for (uint32_t i = 0; i < packets; ++i) {
+        Ptr<Packet> p = m_payload->Copy();
+        SeqTsHeader header;             // stamped with the current time
+        header.SetSeq(m_seq++);
+        p->AddHeader(header);
+        m_txTrace(p);
+        m_socket->Send(p);
+    }
+
+    double gap = packets * m_packetSize * 8.0 / m_dataRate.GetBitRate();
+    if (m_mode == MODE_POISSON) {
+        gap = m_gap->GetValue(gap, 0.0);
+    }
+    m_sendEvent = Simulator::Schedule(Seconds(gap), &UdpLoadGenerator::Send, this);
+}
+
+
+TypeId UdpLoadSink::GetTypeId(void) {
+    static TypeId tid = TypeId("UdpLoadSink")
+        .SetParent<Application>()
+        .AddConstructor<UdpLoadSink>()
+        .AddAttribute("Port", "UDP port to receive on",
+                      UintegerValue(9),
+                      MakeUintegerAccessor(&UdpLoadSink::m_port),
+                      MakeUintegerChecker<uint16_t>())
+        .AddAttribute("Output", "Binary file of the per packet records, empty for none",
+                      StringValue(""),
+                      MakeStringAccessor(&UdpLoadSink::m_output),
+                      MakeStringChecker())
+        .AddTraceSource("Rx", "A packet is received",
+                        MakeTraceSourceAccessor(&UdpLoadSink::m_rxTrace),
+                        "ns3::Packet::AddressTracedCallback");
+    return tid;
+}
+
+
+UdpLoadSink::UdpLoadSink()
+    : m_port(9),
+      m_file(nullptr),
+      m_written(0) {
+}
+
+
+UdpLoadSink::~UdpLoadSink() {
+    Close();
+}
+
+
+void UdpLoadSink::DoDispose(void) {
+    Close();
+    m_socket = 0;
+    Application::DoDispose();
+}
+
+
+void UdpLoadSink::StartApplication(void) {
+    if (!m_output.empty() && !m_file) {
+        m_file = std::fopen(m_output.c_str(), "wb");
+        if (!m_file) {
+            NS_FATAL_ERROR("Cannot open udp load file " << m_output);
+        }
+        // the record count is written when the file is closed
+        uint64_t count = 0;
+        std::fwrite("UDPLOAD1", 1, 8, m_file);
+        std::fwrite(&count, sizeof(count), 1, m_file);
+        m_records.reserve(4096);
+    }
+    if (!m_socket) {
+        m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+        if (m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port)) == -1) {
+            NS_FATAL_ERROR("Failed to bind udp load sink to port " << m_port);
+        }
+    }
+    m_socket->SetRecvCallback(MakeCallback(&UdpLoadSink::HandleRead, this));
+}
+
+
+void UdpLoadSink::StopApplication(void) {
+    if (m_socket) {
+        m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket> >());
+    }
+    Close();
+}
+
+
+void UdpLoadSink::HandleRead(Ptr<Socket> socket) {
+    Ptr<Packet> p;
+    Address from;
+    while ((p = socket->RecvFrom(from))) {
+        m_rxTrace(p, from);
+        if (!m_file) {
+            continue;
+        }
+        SeqTsHeader header;
+        p->PeekHeader(header);
+        Time now = Simulator::Now();
+        Record record;
+        record.nanoseconds = now.GetNanoSeconds();
+        record.delayNanoseconds = (now - header.GetTs()).GetNanoSeconds();
+        record.seq = header.GetSeq();
+        record.source = InetSocketAddress::ConvertFrom(from).GetIpv4().Get();
+        m_records.push_back(record);
+        if (m_records.size() == m_records.capacity()) {
+            Flush();
+        }
+    }
+}
+
+
+void UdpLoadSink::Flush(void) {
+    std::fwrite(m_records.data(), sizeof(Record), m_records.size(), m_file);
+    m_written += m_records.size();
+    m_records.clear();
+}
+
+
+void UdpLoadSink::Close(void) {
+    if (!m_file) {
+        return;
+    }
+    Flush();
+    std::fseek(m_file, 8, SEEK_SET);
+    std::fwrite(&m_written, sizeof(m_written), 1, m_file);
+    std::fclose(m_file);
+    m_file = nullptr;
+}
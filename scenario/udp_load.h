@@ -0,0 +1,115 @@
+#ifndef UDP_LOAD_H
+#define UDP_LOAD_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ns3/application.h"
+#include "ns3/address.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+
+/*
+ * Paced UDP sender. Packets carry a SeqTsHeader (sequence number and send
+ * time) and leave at DataRate on average:
+ *
+ *   cbr      one packet every PacketSize * 8 / DataRate
+ *   poisson  exponentially distributed gaps of that mean
+ *   burst    BurstPackets back to back every BurstPackets gaps
+ *
+ * The payload is one packet made at start; every send copies it, which
+ * shares its buffer, and only adds the 12 byte header.
+ */
+class UdpLoadGenerator : public ns3::Application {
+public:
+    enum Mode {
+        MODE_CBR,
+        MODE_POISSON,
+        MODE_BURST
+    };
+
+    static ns3::TypeId GetTypeId(void);
+
+    UdpLoadGenerator();
+    virtual ~UdpLoadGenerator();
+
+    int64_t AssignStreams(int64_t stream);
+
+protected:
+    virtual void DoDispose(void);
+
+private:
+    virtual void StartApplication(void);
+    virtual void StopApplication(void);
+
+    void Send(void);
+
+    ns3::Address m_remote;
+    uint32_t m_packetSize;
+    ns3::DataRate m_dataRate;
+    Mode m_mode;
+    uint32_t m_burstPackets;
+
+    ns3::Ptr<ns3::Socket> m_socket;
+    ns3::Ptr<ns3::Packet> m_payload;
+    ns3::Ptr<ns3::ExponentialRandomVariable> m_gap;
+    ns3::EventId m_sendEvent;
+    uint32_t m_seq;
+
+    ns3::TracedCallback<ns3::Ptr<const ns3::Packet> > m_txTrace;
+};
+
+
+/*
+ * Receives the UdpLoadGenerator packets. With Output set, every packet is
+ * appended to a binary file:
+ *
+ *   char     magic[8]      "UDPLOAD1"
+ *   uint64_t records
+ *   records in arrival order, 24 bytes each, little endian:
+ *     int64_t  nanoseconds         arrival time
+ *     int64_t  delayNanoseconds    one-way delay, arrival - send time
+ *     uint32_t seq                 sequence number, per sender from 0
+ *     uint32_t source              sender IPv4 address
+ */
+class UdpLoadSink : public ns3::Application {
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    UdpLoadSink();
+    virtual ~UdpLoadSink();
+
+protected:
+    virtual void DoDispose(void);
+
+private:
+    struct Record {
+        int64_t nanoseconds;
+        int64_t delayNanoseconds;
+        uint32_t seq;
+        uint32_t source;
+    };
+
+    virtual void StartApplication(void);
+    virtual void StopApplication(void);
+
+    void HandleRead(ns3::Ptr<ns3::Socket> socket);
+    void Flush(void);
+    void Close(void);
+
+    uint16_t m_port;
+    std::string m_output;
+
+    ns3::Ptr<ns3::Socket> m_socket;
+    std::FILE * m_file;
+    std::vector<Record> m_records;
+    uint64_t m_written;
+
+    ns3::TracedCallback<ns3::Ptr<const ns3::Packet>, const ns3::Address &> m_rxTrace;
+};
+
+#endif /* UDP_LOAD_H */
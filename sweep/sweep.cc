@@ -0,0 +1,518 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ======================================================
+//
+//  Parallel parameter sweep over the scenario program.
+//
+//  Every (point, RngRun) pair is one worker process running
+//      <program> <point options> --RngRun=<n> --outputDir=<outputDir>/run_<i> --summary=true <extra options>
+//  at most --jobs of them at a time. Each run writes its pcap/dat/summary
+//  files into its own run_<i> directory, and the one-row summaries are
+//  merged into <outputDir>/results.csv once every run has finished.
+//
+//  ./sweep --program=build/scratch/scenario/scenario --jobs=64
+//          --grid=receiverRanVarMin=0.5:0.95:0.05 --grid=interRanVarMin=0.5:0.95:0.05
+//          --rngRuns=1:5 -- --sender=csma --receiver=csma --transport=tcp --seconds=100
+//
+//  --compare=NAME then reports the mean and deviation over the seeds of
+//  every value of the parameter NAME, e.g. one row per --tcpVariant, best
+//  first column first: highest, or lowest for a column given as -name.
+//
+// ======================================================
+
+
+struct Point {
+    std::vector<std::string> values;    // one per parameter name
+};
+
+
+struct Run {
+    size_t point;
+    std::string rngRun;
+    std::string dir;
+    pid_t pid = -1;
+    int status = -1;
+};
+
+
+static void Usage(const char * argv0) {
+    std::cerr << "usage: " << argv0 << " --program=PATH [options] [-- extra scenario options]\n"
+              << "  --program=PATH          scenario binary (run it from ./waf shell)\n"
+              << "  --jobs=N                parallel worker processes (default: online cores)\n"
+              << "  --outputDir=DIR         base directory for run_<i>/ and results.csv (default: sweep)\n"
+              << "  --grid=NAME=VALUES      grid axis, VALUES is a,b,c or start:stop:step; repeat for more axes\n"
+              << "  --points=FILE           one point per line: NAME=VALUE NAME=VALUE ...\n"
+              << "  --rngRuns=VALUES        RngRun seeds, a,b,c or start:stop (default: 1)\n"
+              << "  --compare=NAME          compare the values of parameter NAME over the seeds, into compare.csv\n"
+              << "  --columns=A,-B,...      summary columns compared, -name where lower is better; rows are sorted by the first\n"
+              << "                          (default: goodputBps,-retransmissionRatio,-completionSeconds)\n";
+}
+
+
+static bool StartsWith(const std::string & s, const std::string & prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+
+static std::vector<std::string> Split(const std::string & s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, sep)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+
+/* a,b,c or start:stop[:step], stop inclusive */
+static std::vector<std::string> ParseValues(const std::string & spec) {
+    std::vector<std::string> range = Split(spec, ':');
+    if (range.size() < 2) {
+        return Split(spec, ',');
+    }
+    double start = std::atof(range[0].c_str());
+    double stop = std::atof(range[1].c_str());
+    double step = range.size() > 2 ? std::atof(range[2].c_str()) : 1.0;
+    std::vector<std::string> values;
+    if (step <= 0) {
+        std::cerr << "bad step in " << spec << "\n";
+        std::exit(1);
+    }
+    for (size_t i = 0; start + i * step <= stop + step * 1e-6; ++i) {
+        std::ostringstream value;
+        value.precision(10);
+        value << start + i * step;
+        values.push_back(value.str());
+    }
+    return values;
+}
+
+
+static void MakeDirectories(const std::string & path) {
+    std::string partial;
+    for (const std::string & part : Split(path, '/')) {
+        partial += (partial.empty() && path[0] != '/') ? part : "/" + part;
+        if (mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST) {
+            std::cerr << "cannot create " << partial << ": " << std::strerror(errno) << "\n";
+            std::exit(1);
+        }
+    }
+}
+
+
+/* cartesian product of the grid axes */
+static void ExpandGrid(const std::vector<std::vector<std::string> > & axes, size_t axis, Point & current, std::vector<Point> & points) {
+    if (axis == axes.size()) {
+        points.push_back(current);
+        return;
+    }
+    for (const std::string & value : axes[axis]) {
+        current.values.push_back(value);
+        ExpandGrid(axes, axis + 1, current, points);
+        current.values.pop_back();
+    }
+}
+
+
+static void ReadPoints(const std::string & file, std::vector<std::string> & names, std::vector<Point> & points) {
+    std::ifstream in(file.c_str());
+    if (!in) {
+        std::cerr << "cannot open " << file << "\n";
+        std::exit(1);
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string field;
+        Point point;
+        point.values.assign(names.size(), "");
+        while (fields >> field) {
+            size_t eq = field.find('=');
+            if (eq == std::string::npos) {
+                continue;
+            }
+            std::string name = field.substr(0, eq);
+            size_t index = 0;
+            while (index < names.size() && names[index] != name) {
+                index++;
+            }
+            if (index == names.size()) {
+                names.push_back(name);
+                for (Point & previous : points) {
+                    previous.values.push_back("");
+                }
+                point.values.push_back("");
+            }
+            point.values[index] = field.substr(eq + 1);
+        }
+        points.push_back(point);
+    }
+}
+
+
+static pid_t Spawn(const std::string & program, const std::vector<std::string> & args, const std::string & logFile) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    int fd = open(logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+    }
+    std::vector<char *> argv;
+    argv.push_back(const_cast<char *>(program.c_str()));
+    for (const std::string & arg : args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    execv(program.c_str(), argv.data());
+    std::perror("execv");
+    _exit(127);
+}
+
+
+/* header and row of the run's <name>_summary.csv, empty if the run wrote none */
+static bool ReadSummary(const std::string & dir, std::string & header, std::string & row) {
+    DIR * d = opendir(dir.c_str());
+    if (!d) {
+        return false;
+    }
+    std::string summaryFile;
+    const std::string suffix = "_summary.csv";
+    while (struct dirent * entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            summaryFile = dir + "/" + name;
+            break;
+        }
+    }
+    closedir(d);
+    if (summaryFile.empty()) {
+        return false;
+    }
+    std::ifstream in(summaryFile.c_str());
+    return std::getline(in, header) && std::getline(in, row);
+}
+
+
+/* mean and sample standard deviation */
+static void MeanDeviation(const std::vector<double> & values, double & mean, double & deviation) {
+    mean = 0.0;
+    deviation = 0.0;
+    if (values.empty()) {
+        return;
+    }
+    for (double value : values) {
+        mean += value;
+    }
+    mean /= values.size();
+    if (values.size() > 1) {
+        for (double value : values) {
+            deviation += (value - mean) * (value - mean);
+        }
+        deviation = std::sqrt(deviation / (values.size() - 1));
+    }
+}
+
+
+/* one row per value of the compared parameter, best first column mean first:
+   the highest, or the lowest with lowerFirst */
+static bool WriteComparison(const std::string & path, const std::string & name, const std::vector<std::string> & columns, bool lowerFirst,
+                            const std::vector<std::string> & order, std::map<std::string, std::vector<std::vector<double> > > & samples) {
+    struct Row {
+        std::string value;
+        size_t runs;
+        std::vector<double> means;
+        std::vector<double> deviations;
+    };
+    std::vector<Row> rows;
+    for (const std::string & value : order) {
+        Row row;
+        row.value = value;
+        row.runs = samples[value][0].size();
+        for (size_t c = 0; c < columns.size(); ++c) {
+            double mean, deviation;
+            MeanDeviation(samples[value][c], mean, deviation);
+            row.means.push_back(mean);
+            row.deviations.push_back(deviation);
+        }
+        rows.push_back(row);
+    }
+    std::stable_sort(rows.begin(), rows.end(), [lowerFirst](const Row & a, const Row & b) {
+        return lowerFirst ? a.means[0] < b.means[0] : a.means[0] > b.means[0];
+    });
+
+    std::ofstream out(path.c_str());
+    if (!out) {
+        std::cerr << "cannot create " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    // cells are "mean +- deviation"
+    std::vector<size_t> widths;
+    out << name << ",runs";
+    std::cout << std::left << std::setw(16) << name << std::right << std::setw(6) << "runs";
+    for (const std::string & column : columns) {
+        widths.push_back(std::max<size_t>(column.size(), 22) + 2);
+        out << "," << column << "Mean," << column << "Deviation";
+        std::cout << std::setw(widths.back()) << column;
+    }
+    out << "\n";
+    std::cout << "\n";
+    for (const Row & row : rows) {
+        out << row.value << "," << row.runs;
+        std::cout << std::left << std::setw(16) << row.value << std::right << std::setw(6) << row.runs;
+        for (size_t c = 0; c < columns.size(); ++c) {
+            out << "," << row.means[c] << "," << row.deviations[c];
+            std::ostringstream cell;
+            cell << std::setprecision(4) << row.means[c] << " +- " << row.deviations[c];
+            std::cout << std::setw(widths[c]) << cell.str();
+        }
+        out << "\n";
+        std::cout << "\n";
+    }
+    return true;
+}
+
+
+int main(int argc, char *argv[]) {
+
+    std::string program;
+    unsigned jobs = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    std::string outputDir = "sweep";
+    std::vector<std::string> names;
+    std::vector<std::vector<std::string> > axes;
+    std::string pointsFile;
+    std::vector<std::string> rngRuns(1, "1");
+    std::vector<std::string> extra;
+    std::string compare;
+    std::vector<std::string> columns = { "goodputBps", "-retransmissionRatio", "-completionSeconds" };
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--") {
+            extra.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        else if (StartsWith(arg, "--program=")) {
+            program = arg.substr(10);
+        }
+        else if (StartsWith(arg, "--jobs=")) {
+            jobs = std::max(1, std::atoi(arg.c_str() + 7));
+        }
+        else if (StartsWith(arg, "--outputDir=")) {
+            outputDir = arg.substr(12);
+        }
+        else if (StartsWith(arg, "--grid=")) {
+            std::string axis = arg.substr(7);
+            size_t eq = axis.find('=');
+            if (eq == std::string::npos) {
+                Usage(argv[0]);
+                return 1;
+            }
+            names.push_back(axis.substr(0, eq));
+            axes.push_back(ParseValues(axis.substr(eq + 1)));
+        }
+        else if (StartsWith(arg, "--points=")) {
+            pointsFile = arg.substr(9);
+        }
+        else if (StartsWith(arg, "--rngRuns=")) {
+            rngRuns = ParseValues(arg.substr(10));
+        }
+        else if (StartsWith(arg, "--compare=")) {
+            compare = arg.substr(10);
+        }
+        else if (StartsWith(arg, "--columns=")) {
+            columns = Split(arg.substr(10), ',');
+        }
+        else {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+    if (program.empty() || (!axes.empty() && !pointsFile.empty()) || columns.empty()) {
+        Usage(argv[0]);
+        return 1;
+    }
+    // -name: lower is better, only the first column's sign orders the rows
+    bool lowerFirst = StartsWith(columns[0], "-");
+    for (std::string & column : columns) {
+        if (StartsWith(column, "-")) {
+            column = column.substr(1);
+        }
+    }
+
+
+    /* points */
+    std::vector<Point> points;
+    if (!pointsFile.empty()) {
+        ReadPoints(pointsFile, names, points);
+    }
+    else {
+        Point current;
+        ExpandGrid(axes, 0, current, points);
+    }
+
+    std::vector<Run> runs;
+    for (size_t p = 0; p < points.size(); ++p) {
+        for (const std::string & rngRun : rngRuns) {
+            Run run;
+            run.point = p;
+            run.rngRun = rngRun;
+            run.dir = outputDir + "/run_" + std::to_string(runs.size());
+            runs.push_back(run);
+        }
+    }
+    size_t compareIndex = std::find(names.begin(), names.end(), compare) - names.begin();
+    if (!compare.empty() && compareIndex == names.size()) {
+        std::cerr << "--compare=" << compare << " is not a --grid or --points parameter\n";
+        return 1;
+    }
+    std::cerr << points.size() << " points x " << rngRuns.size() << " seeds = " << runs.size() << " runs on " << jobs << " workers\n";
+
+
+    /* bounded worker pool */
+    size_t next = 0;
+    size_t running = 0;
+    size_t finished = 0;
+    while (finished < runs.size()) {
+        while (running < jobs && next < runs.size()) {
+            Run & run = runs[next];
+            MakeDirectories(run.dir);
+            std::vector<std::string> args;
+            for (size_t n = 0; n < names.size(); ++n) {
+                if (!points[run.point].values[n].empty()) {
+                    args.push_back("--" + names[n] + "=" + points[run.point].values[n]);
+                }
+            }
+            args.push_back("--RngRun=" + run.rngRun);
+            args.push_back("--outputDir=" + run.dir);
+            args.push_back("--summary=true");
+            args.insert(args.end(), extra.begin(), extra.end());
+            run.pid = Spawn(program, args, run.dir + "/stdout.log");
+            if (run.pid < 0) {
+                std::perror("fork");
+                return 1;
+            }
+            running++;
+            next++;
+        }
+
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0) {
+            std::perror("wait");
+            return 1;
+        }
+        for (Run & run : runs) {
+            if (run.pid == pid) {
+                run.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+                if (run.status != 0) {
+                    std::cerr << run.dir << " failed with status " << run.status << "\n";
+                }
+                break;
+            }
+        }
+        running--;
+        finished++;
+        std::cerr << "\r" << finished << "/" << runs.size() << std::flush;
+    }
+    std::cerr << "\n";
+
+
+    /* merge */
+    if (!compare.empty()) {
+        // every compared column must be in the summary, or its means would be 0
+        for (const Run & run : runs) {
+            std::string header, row;
+            if (run.status != 0 || !ReadSummary(run.dir, header, row)) {
+                continue;
+            }
+            std::vector<std::string> headerNames = Split(header, ',');
+            for (const std::string & column : columns) {
+                if (std::find(headerNames.begin(), headerNames.end(), column) == headerNames.end()) {
+                    std::cerr << "--columns: " << column << " is not a summary column, valid names: " << header << "\n";
+                    return 1;
+                }
+            }
+            break;
+        }
+    }
+    std::string resultsFile = outputDir + "/results.csv";
+    std::ofstream results(resultsFile.c_str());
+    bool headerWritten = false;
+    size_t failed = 0;
+    std::vector<std::string> compareOrder;
+    std::map<std::string, std::vector<std::vector<double> > > compareSamples;    // value -> column -> one per run
+    for (size_t r = 0; r < runs.size(); ++r) {
+        std::string header, row;
+        bool ok = runs[r].status == 0 && ReadSummary(runs[r].dir, header, row);
+        failed += ok ? 0 : 1;
+        if (!ok) {
+            continue;
+        }
+        if (!headerWritten) {
+            results << "run,rngRun";
+            for (const std::string & name : names) {
+                results << "," << name;
+            }
+            results << "," << header << "\n";
+            headerWritten = true;
+        }
+        results << r << "," << runs[r].rngRun;
+        for (const std::string & value : points[runs[r].point].values) {
+            results << "," << value;
+        }
+        results << "," << row << "\n";
+
+        if (!compare.empty()) {
+            std::vector<std::string> headerNames = Split(header, ',');
+            std::vector<std::string> fields = Split(row, ',');
+            const std::string & value = points[runs[r].point].values[compareIndex];
+            if (compareSamples.find(value) == compareSamples.end()) {
+                compareOrder.push_back(value);
+                compareSamples[value].resize(columns.size());
+            }
+            for (size_t c = 0; c < columns.size(); ++c) {
+                size_t field = std::find(headerNames.begin(), headerNames.end(), columns[c]) - headerNames.begin();
+                compareSamples[value][c].push_back(field < fields.size() ? std::atof(fields[field].c_str()) : 0.0);
+            }
+        }
+    }
+    std::cerr << "merged " << runs.size() - failed << " runs into " << resultsFile;
+    if (failed > 0) {
+        std::cerr << ", " << failed << " failed (see run_<i>/stdout.log)";
+    }
+    std::cerr << "\n";
+
+    if (!compare.empty() && !compareOrder.empty() && !WriteComparison(outputDir + "/compare.csv", compare, columns, lowerFirst, compareOrder, compareSamples)) {
+        return 1;
+    }
+
+
+    return failed > 0 ? 1 : 0;
+}